@@ -0,0 +1,759 @@
+/* benchmark.cpp
+ * Microbenchmarks for the simulator's hot paths (built by `make bench`).
+ *
+ * Every result is one line of key=value pairs in a fixed order, e.g.
+ *   bench protocol=4G name=tower_churn param=fill_50 ops=12000 ns_per_op=41.27 ops_per_sec=24230000 peak_rss_kb=5412
+ * so runs can be diffed or joined on (protocol, name, param).
+ *
+ * `benchmark --verify` instead checks the equivalences the fast paths promise
+ * (SpatialGrid vs a linear scan, generateBatch vs generateMessage, snapshot
+ * save/load round trips, device balancing across cores), prints one
+ *   verify protocol=... name=... cases=N failures=N ok=0|1
+ * line per check and exits with status 1 if any of them fails.
+ */
+
+#include "../include/CellTower.h"
+#include "../include/CellularCore.h"
+#include "../include/CellularNetwork.h"
+#include "../include/Clock.h"
+#include "../include/CustomProtocol.h"
+#include "../include/DeviceInventory.h"
+#include "../include/EventSimulator.h"
+#include "../include/Protocol2G.h"
+#include "../include/Protocol3G.h"
+#include "../include/Protocol4G.h"
+#include "../include/Protocol5G.h"
+#include "../include/SpatialGrid.h"
+#include "../include/Snapshot.h"
+#include "../include/ThreadPool.h"
+#include "../include/basicIO.h"
+
+#include <cmath> // for std::sqrt
+
+#define SYS_WRITE 1
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define SYS_READ 0
+#define SYS_DUP 32
+#define SYS_DUP2 33
+#define SYS_UNLINK 87
+#define O_RDONLY 0
+#define O_WRONLY 1
+#define O_CREAT 64
+#define O_TRUNC 512
+#define STDOUT 1
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+static const char* CSV_PATH = "/tmp/oopd_bench_users.csv";
+static const int CSV_ROWS = 1000000;
+static const char* SNAPSHOT_PATH = "/tmp/oopd_bench_network.snap";
+static const int CHURN_FILLS[] = { 25, 50, 90, 100 };
+static const long long MESSAGE_COUNTS[] = { 1000, 10000, 100000, 1000000, 10000000 };
+static const int TOWER_COUNTS[] = { 100, 1000, 10000 };
+
+static bool quickMode = false;
+static bool verifyMode = false;
+
+static bool sameText(const char* a, const char* b) {
+    int k = 0;
+    while (a[k] && a[k] == b[k]) ++k;
+    return a[k] == b[k];
+}
+
+// ---------------------------------------------------------------------------
+// Measurement helpers
+// ---------------------------------------------------------------------------
+
+// Resets the kernel's peak-RSS mark so each protocol reports its own peak.
+// Needs Linux 4.0+; on failure the reported peak is cumulative for the process.
+static void resetPeakRss() {
+    long fd = syscall3(SYS_OPEN, (long)"/proc/self/clear_refs", O_WRONLY, 0);
+    if (fd < 0) return;
+    syscall3(SYS_WRITE, fd, (long)"5", 1);
+    syscall3(SYS_CLOSE, fd, 0, 0);
+}
+
+// VmHWM from /proc/self/status, in kB (0 if unavailable).
+static long long peakRssKb() {
+    long fd = syscall3(SYS_OPEN, (long)"/proc/self/status", O_RDONLY, 0);
+    if (fd < 0) return 0;
+    char buffer[4096];
+    long length = syscall3(SYS_READ, fd, (long)buffer, sizeof(buffer) - 1);
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    if (length <= 0) return 0;
+    buffer[length] = '\0';
+
+    const char* key = "VmHWM:";
+    for (long i = 0; i + 6 < length; ++i) {
+        int k = 0;
+        while (key[k] && buffer[i + k] == key[k]) ++k;
+        if (key[k]) continue;
+        long long value = 0;
+        for (long j = i + k; j < length && buffer[j] != '\n'; ++j) {
+            if (buffer[j] >= '0' && buffer[j] <= '9') value = value * 10 + (buffer[j] - '0');
+        }
+        return value;
+    }
+    return 0;
+}
+
+static unsigned int lcgState = 12345u;
+
+static unsigned int nextRandom() {
+    lcgState = lcgState * 1664525u + 1013904223u;
+    return lcgState >> 8;
+}
+
+static void report(const char* protocol, const char* name, const char* param, long long paramValue,
+                   long long ops, long long elapsedNs) {
+    io.outputstring("bench protocol="); io.outputstring(protocol);
+    io.outputstring(" name="); io.outputstring(name);
+    io.outputstring(" param="); io.outputstring(param);
+    if (paramValue >= 0) io.outputlong(paramValue);
+    io.outputstring(" ops="); io.outputlong(ops);
+
+    long long hundredths = ops > 0 ? elapsedNs * 100 / ops : 0;
+    io.outputstring(" ns_per_op="); io.outputlong(hundredths / 100);
+    io.outputstring(hundredths % 100 < 10 ? ".0" : ".");
+    io.outputlong(hundredths % 100);
+
+    io.outputstring(" ops_per_sec="); io.outputlong(Clock::ratePerSecond(ops, elapsedNs));
+    io.outputstring(" peak_rss_kb="); io.outputlong(peakRssKb());
+    io.terminate();
+    io.flush();
+}
+
+// ---------------------------------------------------------------------------
+// Tower: attach/detach
+// ---------------------------------------------------------------------------
+
+static void benchTower(const char* name, const CommunicationProtocol* protocol) {
+    CellTower tower(1, protocol);
+    int capacity = tower.getCapacity();
+    if (capacity <= 0) return;
+
+    long long start = Clock::nowNanoseconds();
+    for (int id = 1; id <= capacity; ++id) {
+        tower.addUserDevice(id, (id % 3 == 0) ? ConnectionType::VOICE : ConnectionType::DATA);
+    }
+    report(name, "tower_fill", "fill_", 100, capacity, Clock::nowNanoseconds() - start);
+
+    // Channel statistics on the full tower; ops = channels summarized.
+    int statsRounds = quickMode ? 20 : 200;
+    long long checksum = 0;
+    start = Clock::nowNanoseconds();
+    for (int r = 0; r < statsRounds; ++r) checksum += tower.getChannelStats().total.sum;
+    long long statsNs = Clock::nowNanoseconds() - start;
+    if (checksum > 0) {
+        report(name, "channel_stats", "fill_", 100,
+               static_cast<long long>(statsRounds) * tower.getChannelCount(), statsNs);
+    }
+
+    // Churn: one remove of a random attached device plus one add, at a fixed fill level.
+    int nextId = capacity + 1;
+    int churnOps = capacity < 100000 ? capacity : 100000;
+    if (churnOps < 10000) churnOps = 10000;
+    for (int f = 0; f < 4; ++f) {
+        int target = static_cast<int>(static_cast<long long>(capacity) * CHURN_FILLS[f] / 100);
+        if (target < 1) target = 1;
+        while (tower.getDeviceCount() > target) {
+            tower.removeUserDevice(tower.getDeviceId(tower.getDeviceCount() - 1));
+        }
+        while (tower.getDeviceCount() < target) {
+            tower.addUserDevice(nextId++, ConnectionType::DATA);
+        }
+
+        start = Clock::nowNanoseconds();
+        for (int i = 0; i < churnOps; ++i) {
+            int victim = tower.getDeviceId(static_cast<int>(nextRandom() % tower.getDeviceCount()));
+            tower.removeUserDevice(victim);
+            tower.addUserDevice(nextId++, ConnectionType::DATA);
+        }
+        report(name, "tower_churn", "fill_", CHURN_FILLS[f], churnOps, Clock::nowNanoseconds() - start);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Core: generate / process
+// ---------------------------------------------------------------------------
+
+static void benchCore(const char* name, const CommunicationProtocol* protocol) {
+    CellularCore core(1);
+    CellTower* tower = new CellTower(1, protocol);
+    core.addCellTower(tower); // core owns the tower
+    int capacity = tower->getCapacity();
+    for (int id = 1; id <= capacity; ++id) tower->addUserDevice(id, ConnectionType::DATA);
+    int devices = tower->getDeviceCount();
+    if (devices == 0) return;
+
+    int* ids = new int[devices];
+    for (int i = 0; i < devices; ++i) ids[i] = tower->getDeviceId(i);
+    int voicePayload = core.internPayload("Voice call");
+    int dataPayload = core.internPayload("Data packet");
+
+    for (int m = 0; m < 5; ++m) {
+        long long total = MESSAGE_COUNTS[m];
+        if (quickMode && total > 100000) break;
+
+        long long generateNs = 0;
+        long long processNs = 0;
+        long long done = 0;
+        while (done < total) {
+            long long batch = total - done;
+            if (batch > CellularCore::MAX_MESSAGES) batch = CellularCore::MAX_MESSAGES;
+
+            long long t0 = Clock::nowNanoseconds();
+            for (long long j = done; j < done + batch; ++j) {
+                bool isVoice = (j & 3) == 0;
+                core.generateMessage(ids[j % devices], 1, isVoice, isVoice ? voicePayload : dataPayload);
+            }
+            long long t1 = Clock::nowNanoseconds();
+            core.processPending(static_cast<int>(batch));
+            long long t2 = Clock::nowNanoseconds();
+
+            generateNs += t1 - t0;
+            processNs += t2 - t1;
+            done += batch;
+        }
+        report(name, "core_generate", "messages_", total, total, generateNs);
+        report(name, "core_process", "messages_", total, total, processNs);
+
+        // Same traffic through generateBatch (one call per queue fill).
+        TrafficPattern pattern;
+        pattern.senders = ids;
+        pattern.senderCount = devices;
+        pattern.toTowerId = 1;
+        pattern.voicePayload = voicePayload;
+        pattern.dataPayload = dataPayload;
+        generateNs = 0;
+        done = 0;
+        while (done < total) {
+            long long t0 = Clock::nowNanoseconds();
+            TrafficCounts batch = core.generateBatch(pattern, total - done);
+            generateNs += Clock::nowNanoseconds() - t0;
+            if (batch.voice + batch.data == 0) break;
+            done += batch.voice + batch.data;
+            core.processPending(CellularCore::MAX_MESSAGES);
+        }
+        report(name, "core_generate_batch", "messages_", total, done, generateNs);
+    }
+    delete[] ids;
+}
+
+// ---------------------------------------------------------------------------
+// Event-driven model: a full tower offered 90% of its channel capacity
+// ---------------------------------------------------------------------------
+
+static void benchEvents(const char* name, const CommunicationProtocol* protocol) {
+    CellTower tower(1, protocol);
+    int capacity = tower.getCapacity();
+    if (capacity <= 0) return;
+    for (int id = 1; id <= capacity; ++id) tower.addUserDevice(id, ConnectionType::DATA);
+
+    double channelRate = static_cast<double>(protocol->getUsersPerChannel()) * protocol->getMessagesPerUser();
+    EventConfig config;
+    config.durationNs = quickMode ? 1000000000LL : 10000000000LL;
+    config.arrivalRate = 0.9 * channelRate * tower.getChannelCount() / tower.getDeviceCount();
+
+    CellTower* towers[1] = { &tower };
+    EventSimulator events(towers, 1, config);
+    events.run();
+    const EventStats& stats = events.getStats();
+    report(name, "event_sim", "load_", 90, stats.events, stats.wallNs);
+}
+
+// ---------------------------------------------------------------------------
+// Nearest-tower search: SpatialGrid vs linear scan
+// ---------------------------------------------------------------------------
+
+static double nextCoordinate(double extent) {
+    return (nextRandom() & 0xFFFFFF) * (extent / 16777216.0);
+}
+
+static void benchSpatial() {
+    int queries = quickMode ? 100000 : 1000000;
+    double* qx = new double[queries];
+    double* qy = new double[queries];
+
+    for (int n = 0; n < 3; ++n) {
+        int towers = TOWER_COUNTS[n];
+        double extent = 1000.0 * std::sqrt(static_cast<double>(towers)); // one tower per km^2
+        double* tx = new double[towers];
+        double* ty = new double[towers];
+        for (int t = 0; t < towers; ++t) {
+            tx[t] = nextCoordinate(extent);
+            ty[t] = nextCoordinate(extent);
+        }
+        for (int q = 0; q < queries; ++q) {
+            qx[q] = nextCoordinate(extent);
+            qy[q] = nextCoordinate(extent);
+        }
+
+        long long start = Clock::nowNanoseconds();
+        SpatialGrid grid;
+        grid.build(tx, ty, towers, 0, 0, extent, extent);
+        report("all", "tower_index_build", "towers_", towers, towers, Clock::nowNanoseconds() - start);
+
+        long long checksum = 0;
+        start = Clock::nowNanoseconds();
+        for (int q = 0; q < queries; ++q) {
+            double d2;
+            checksum += grid.nearest(qx[q], qy[q], d2);
+        }
+        report("all", "nearest_grid", "towers_", towers, queries, Clock::nowNanoseconds() - start);
+
+        // The scan is O(towers) per query, so it gets fewer queries at large counts.
+        int scanQueries = static_cast<int>(200000000LL / towers);
+        if (scanQueries > queries) scanQueries = queries;
+        if (quickMode) scanQueries /= 10;
+        long long scanChecksum = 0;
+        long long gridChecksum = 0;
+        start = Clock::nowNanoseconds();
+        for (int q = 0; q < scanQueries; ++q) {
+            double d2;
+            scanChecksum += SpatialGrid::nearestByScan(tx, ty, towers, qx[q], qy[q], d2);
+        }
+        report("all", "nearest_scan", "towers_", towers, scanQueries, Clock::nowNanoseconds() - start);
+
+        for (int q = 0; q < scanQueries; ++q) {
+            double d2;
+            gridChecksum += grid.nearest(qx[q], qy[q], d2);
+        }
+        if (gridChecksum != scanChecksum || checksum < 0) {
+            io.errorstring("Error: grid and scan disagree on nearest towers\n");
+        }
+
+        delete[] tx;
+        delete[] ty;
+    }
+    delete[] qx;
+    delete[] qy;
+}
+
+// ---------------------------------------------------------------------------
+// CSV loading
+// ---------------------------------------------------------------------------
+
+static bool writeCsv(const char* path, int rows) {
+    long fd = syscall3(SYS_OPEN, (long)path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    char buffer[1 << 16];
+    int length = 0;
+    for (int id = 1; id <= rows; ++id) {
+        char digits[16];
+        int n = 0;
+        for (int v = id; v > 0; v /= 10) digits[n++] = static_cast<char>('0' + v % 10);
+        while (n > 0) buffer[length++] = digits[--n];
+        buffer[length++] = ',';
+        buffer[length++] = (id % 3 == 0) ? 'V' : 'D';
+        buffer[length++] = '\n';
+        if (length > static_cast<int>(sizeof(buffer)) - 32) {
+            syscall3(SYS_WRITE, fd, (long)buffer, length);
+            length = 0;
+        }
+    }
+    if (length > 0) syscall3(SYS_WRITE, fd, (long)buffer, length);
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    return true;
+}
+
+static void benchCsvParse() {
+    for (int threads = 1; threads <= ThreadPool::hardwareThreads(); threads *= 4) {
+        DeviceInventory inventory;
+        long long start = Clock::nowNanoseconds();
+        inventory.loadFile(CSV_PATH, threads);
+        report("all", "csv_parse", "threads_", threads, inventory.getCount(), Clock::nowNanoseconds() - start);
+    }
+}
+
+static void benchCsvAttach(const char* name, const CommunicationProtocol* protocol) {
+    DeviceInventory inventory;
+    if (!inventory.loadFile(CSV_PATH, 0)) return;
+
+    CellularNetwork network(protocol, protocol->calculateRequiredCores(), 1);
+    long long start = Clock::nowNanoseconds();
+    // Every parsed row; the network stops at its own maximum.
+    int added = network.addUserDevices(inventory.getIds(), inventory.getTypes(), inventory.getCount());
+    report(name, "csv_attach", "rows", -1, added, Clock::nowNanoseconds() - start);
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot: populate a network one device at a time vs restore it from a file
+// ---------------------------------------------------------------------------
+
+static void benchSnapshot(const char* name, const CommunicationProtocol* protocol) {
+    int cores = protocol->calculateRequiredCores();
+    CellularNetwork network(protocol, cores, 1);
+    int devices = network.getMaxDevices() < CellTower::MAX_DEVICES ? network.getMaxDevices() : CellTower::MAX_DEVICES;
+    if (devices <= 0) return;
+
+    long long start = Clock::nowNanoseconds();
+    for (int id = 1; id <= devices; ++id) {
+        if (!network.addUserDevice(5000 + id, (id % 3 == 0) ? ConnectionType::VOICE : ConnectionType::DATA)) break;
+    }
+    report(name, "network_fill", "devices", -1, network.getDeviceCount(), Clock::nowNanoseconds() - start);
+
+    start = Clock::nowNanoseconds();
+    if (!network.saveSnapshot(SNAPSHOT_PATH)) return;
+    report(name, "snapshot_save", "devices", -1, network.getDeviceCount(), Clock::nowNanoseconds() - start);
+
+    CellularNetwork restored(protocol, cores, 1);
+    start = Clock::nowNanoseconds();
+    bool ok = restored.loadSnapshot(SNAPSHOT_PATH);
+    long long elapsed = Clock::nowNanoseconds() - start;
+    if (ok) report(name, "snapshot_load", "devices", -1, restored.getDeviceCount(), elapsed);
+    syscall3(SYS_UNLINK, (long)SNAPSHOT_PATH, 0, 0);
+}
+
+// ---------------------------------------------------------------------------
+// basicIO output
+// ---------------------------------------------------------------------------
+
+static void benchOutput() {
+    long long lines = quickMode ? 100000 : 2000000;
+
+    io.flush();
+    long saved = syscall3(SYS_DUP, STDOUT, 0, 0);
+    long devNull = syscall3(SYS_OPEN, (long)"/dev/null", O_WRONLY, 0);
+    if (saved < 0 || devNull < 0) return;
+    syscall3(SYS_DUP2, devNull, STDOUT, 0);
+
+    long long start = Clock::nowNanoseconds();
+    for (long long i = 0; i < lines; ++i) {
+        io.outputstring("message ");
+        io.outputlong(i * 7919);
+        io.outputstring(" processed");
+        io.terminate();
+    }
+    io.flush();
+    long long elapsed = Clock::nowNanoseconds() - start;
+
+    syscall3(SYS_DUP2, saved, STDOUT, 0);
+    syscall3(SYS_CLOSE, saved, 0, 0);
+    syscall3(SYS_CLOSE, devNull, 0, 0);
+    report("all", "basicio_output", "lines", -1, lines, elapsed);
+}
+
+// ---------------------------------------------------------------------------
+// Self-checks (--verify)
+// ---------------------------------------------------------------------------
+
+static bool verdict(const char* protocol, const char* name, long long cases, long long failures) {
+    io.outputstring("verify protocol="); io.outputstring(protocol);
+    io.outputstring(" name="); io.outputstring(name);
+    io.outputstring(" cases="); io.outputlong(cases);
+    io.outputstring(" failures="); io.outputlong(failures);
+    io.outputstring(" ok="); io.outputint(failures == 0 ? 1 : 0);
+    io.terminate();
+    io.flush();
+    return failures == 0;
+}
+
+// Grid answers must equal the scan's, index and distance, ties included.
+static bool verifySpatial() {
+    long long cases = 0;
+    long long failures = 0;
+    for (int round = 0; round < 40; ++round) {
+        int towers = 1 + static_cast<int>(nextRandom() % 3000);
+        double extent = 1000.0 * std::sqrt(static_cast<double>(towers));
+        double* tx = new double[towers];
+        double* ty = new double[towers];
+        for (int t = 0; t < towers; ++t) {
+            if (round % 4 == 1) {
+                // Lattice points: many exactly equidistant candidates.
+                tx[t] = (nextRandom() % 20) * 100.0;
+                ty[t] = (nextRandom() % 20) * 100.0;
+            } else if (round % 4 == 2 && t > 0 && nextRandom() % 3 == 0) {
+                tx[t] = tx[t - 1]; // duplicate sites
+                ty[t] = ty[t - 1];
+            } else {
+                tx[t] = nextCoordinate(extent);
+                ty[t] = nextCoordinate(extent);
+            }
+        }
+        SpatialGrid grid;
+        grid.build(tx, ty, towers, 0, 0, extent, extent);
+        for (int q = 0; q < 2000; ++q) {
+            // Queries also land well outside the indexed region.
+            double x = round % 4 == 1 ? (nextRandom() % 41) * 50.0 - 50.0 : nextCoordinate(extent * 1.5) - extent * 0.25;
+            double y = round % 4 == 1 ? (nextRandom() % 41) * 50.0 - 50.0 : nextCoordinate(extent * 1.5) - extent * 0.25;
+            double gridDistance2;
+            double scanDistance2;
+            int fromGrid = grid.nearest(x, y, gridDistance2);
+            int fromScan = SpatialGrid::nearestByScan(tx, ty, towers, x, y, scanDistance2);
+            cases++;
+            failures += fromGrid != fromScan || gridDistance2 != scanDistance2;
+        }
+        delete[] tx;
+        delete[] ty;
+    }
+    return verdict("all", "spatial_nearest", cases, failures);
+}
+
+static bool sameMessage(const Message& a, const Message& b) {
+    return a.messageId == b.messageId && a.fromDeviceId == b.fromDeviceId && a.toTowerId == b.toTowerId
+        && a.payloadId == b.payloadId && a.isVoice == b.isVoice;
+}
+
+// generateBatch must enqueue exactly what the same generateMessage calls would,
+// across partial drains (so the ring wraps) and for lopsided mixes.
+static bool verifyBatch(const char* name, const CommunicationProtocol* protocol) {
+    static const int MIXES[][2] = { { 3, 1 }, { 1, 3 }, { 2, 2 }, { 0, 1 }, { 5, 0 }, { 7, 4 } };
+    long long cases = 0;
+    long long failures = 0;
+    for (int m = 0; m < 6; ++m) {
+        CellularCore batched(1);
+        CellularCore single(2);
+        CellTower* batchTower = new CellTower(9, protocol);
+        CellTower* singleTower = new CellTower(9, protocol);
+        batched.addCellTower(batchTower);
+        single.addCellTower(singleTower);
+        int devices = batchTower->getCapacity() < 777 ? batchTower->getCapacity() : 777;
+        for (int id = 1; id <= devices; ++id) {
+            batchTower->addUserDevice(id, ConnectionType::DATA);
+            singleTower->addUserDevice(id, ConnectionType::DATA);
+        }
+        if (devices <= 0) continue;
+
+        TrafficPattern pattern;
+        pattern.voiceShare = MIXES[m][0];
+        pattern.dataShare = MIXES[m][1];
+        pattern.senders = batchTower->getDeviceTable().ids();
+        pattern.senderCount = devices;
+        pattern.toTowerId = 9;
+        pattern.voicePayload = batched.internPayload("Voice call");
+        pattern.dataPayload = batched.internPayload("Data packet");
+        single.internPayload("Voice call");
+        single.internPayload("Data packet");
+
+        int cycle = MIXES[m][0] + MIXES[m][1];
+        bool voiceLeads = MIXES[m][0] <= MIXES[m][1];
+        int lead = voiceLeads ? MIXES[m][0] : MIXES[m][1];
+        long long position = 0;
+        for (int round = 0; round < 6; ++round) {
+            TrafficCounts counts = batched.generateBatch(pattern, 30000 + nextRandom() % 50000);
+            long long voice = 0;
+            for (long long k = 0; k < counts.voice + counts.data; ++k, ++position) {
+                bool isVoice = (static_cast<int>(position % cycle) < lead) == voiceLeads;
+                voice += isVoice;
+                single.generateMessage(singleTower->getDeviceId(static_cast<int>(position % devices)), 9, isVoice,
+                                       isVoice ? pattern.voicePayload : pattern.dataPayload);
+            }
+            bool same = voice == counts.voice && batched.getQueueSize() == single.getQueueSize()
+                     && batched.getTotalMessagesGenerated() == single.getTotalMessagesGenerated();
+            for (int i = 0; same && i < batched.getQueueSize(); ++i) {
+                same = sameMessage(batched.getQueuedMessage(i), single.getQueuedMessage(i));
+            }
+            cases++;
+            failures += !same;
+            int drain = 1 + static_cast<int>(nextRandom() % 60000);
+            batched.processPending(drain);
+            single.processPending(drain);
+        }
+    }
+    return verdict(name, "generate_batch", cases, failures);
+}
+
+static bool sameTower(const CellTower* a, const CellTower* b) {
+    const DeviceTable& x = a->getDeviceTable();
+    const DeviceTable& y = b->getDeviceTable();
+    if (x.getCount() != y.getCount() || a->getAllocationPolicy() != b->getAllocationPolicy()) return false;
+    for (int r = 0; r < x.getCount(); ++r) {
+        if (x.getId(r) != y.getId(r) || x.getChannel(r) != y.getChannel(r) || x.getType(r) != y.getType(r)
+            || x.isConnected(r) != y.isConnected(r) || b->findDevice(x.getId(r)) != b->getDevice(r)) {
+            return false;
+        }
+    }
+    ChannelStats sa = a->getChannelStats();
+    ChannelStats sb = b->getChannelStats();
+    if (sa.total.sumSquares != sb.total.sumSquares || sa.voice.sumSquares != sb.voice.sumSquares
+        || sa.busiestChannel != sb.busiestChannel) {
+        return false;
+    }
+    for (int h = 0; h < ChannelStats::HISTOGRAM_BUCKETS; ++h) {
+        if (sa.histogram[h] != sb.histogram[h]) return false;
+    }
+    return true;
+}
+
+// A saved core, restored into a fresh one, must hold the same devices, channel
+// loads, payloads, queued messages and counters, and keep allocating the same way.
+static bool verifySnapshot(const char* name, const CommunicationProtocol* protocol) {
+    long long cases = 0;
+    long long failures = 0;
+    for (int round = 0; round < 4; ++round) {
+        CellularCore original(1);
+        CellTower* tower = new CellTower(3, protocol);
+        original.addCellTower(tower);
+        if (round % 2) tower->setAllocationPolicy(AllocationPolicy::LEAST_LOADED);
+        int capacity = tower->getCapacity();
+        int nextId = 1;
+        for (int i = 0; i < capacity * 3 / 4; ++i) {
+            tower->addUserDevice(nextId++, nextRandom() % 3 == 0 ? ConnectionType::VOICE : ConnectionType::DATA);
+        }
+        for (int i = 0; i < capacity / 5 && tower->getDeviceCount() > 0; ++i) {
+            tower->removeUserDevice(tower->getDeviceId(static_cast<int>(nextRandom() % tower->getDeviceCount())));
+        }
+        if (tower->getDeviceCount() > 0) tower->getDevice(0)->setConnected(false);
+        for (int i = 0; i < 5000 && tower->getDeviceCount() > 0; ++i) {
+            int sender = tower->getDeviceId(static_cast<int>(nextRandom() % tower->getDeviceCount()));
+            original.generateMessage(sender, i % 7 == 0 ? 99 : 3, i % 3 == 0, i % 2 ? "Voice call" : "Data packet");
+        }
+        original.processPending(1234 * round);
+
+        const CellularCore* saved[] = { &original };
+        CellularCore restored(1);
+        CellTower* restoredTower = new CellTower(3, protocol);
+        restored.addCellTower(restoredTower);
+        CellularCore* targets[] = { &restored };
+        bool same = Snapshot::save(SNAPSHOT_PATH, saved, 1) && Snapshot::load(SNAPSHOT_PATH, targets, 1);
+        syscall3(SYS_UNLINK, (long)SNAPSHOT_PATH, 0, 0);
+
+        same = same && sameTower(tower, restoredTower)
+            && original.getQueueSize() == restored.getQueueSize()
+            && original.getPayloadCount() == restored.getPayloadCount()
+            && original.getTotalMessagesGenerated() == restored.getTotalMessagesGenerated()
+            && original.getTotalMessagesProcessed() == restored.getTotalMessagesProcessed()
+            && original.getTotalMessagesFailed() == restored.getTotalMessagesFailed();
+        for (int i = 0; same && i < original.getQueueSize(); ++i) {
+            same = sameMessage(original.getQueuedMessage(i), restored.getQueuedMessage(i));
+        }
+        // Both must keep going identically: attach more devices and drain.
+        for (int i = 0; same && i < capacity / 10; ++i) {
+            same = tower->addUserDevice(nextId, ConnectionType::DATA)
+                == restoredTower->addUserDevice(nextId, ConnectionType::DATA);
+            nextId++;
+        }
+        original.processPending(CellularCore::MAX_MESSAGES);
+        restored.processPending(CellularCore::MAX_MESSAGES);
+        same = same && sameTower(tower, restoredTower)
+            && original.getTotalMessagesProcessed() == restored.getTotalMessagesProcessed()
+            && original.getTotalMessagesFailed() == restored.getTotalMessagesFailed();
+        cases++;
+        failures += !same;
+    }
+    return verdict(name, "snapshot_round_trip", cases, failures);
+}
+
+// Every policy must fill the network to getMaxDevices(), record each device on
+// the core whose tower holds it, and keep round-robin/least-loaded within one
+// device of even. A protocol larger than two towers fills its cores unevenly
+// under hashing, so attach has to move on from a full core.
+static bool verifyBalancing(const char* name, const CommunicationProtocol* protocol, int cores) {
+    static const BalancingPolicy POLICIES[] = {
+        BalancingPolicy::ROUND_ROBIN, BalancingPolicy::LEAST_LOADED, BalancingPolicy::HASHED
+    };
+    long long cases = 0;
+    long long failures = 0;
+    for (int p = 0; p < 3; ++p) {
+        CellularNetwork network(protocol, cores, 1, POLICIES[p]);
+        int devices = network.getMaxDevices();
+        if (devices <= 0) continue;
+
+        // Half through the batch path, half one at a time.
+        int* ids = new int[devices];
+        ConnectionType* types = new ConnectionType[devices];
+        for (int k = 0; k < devices; ++k) {
+            ids[k] = 7 + 3 * k;
+            types[k] = (k % 3 == 0) ? ConnectionType::VOICE : ConnectionType::DATA;
+        }
+        int half = devices / 2;
+        bool same = network.addUserDevices(ids, types, half) == half;
+        for (int k = half; same && k < devices; ++k) {
+            same = network.addUserDevice(ids[k], types[k]);
+        }
+        same = same && network.getDeviceCount() == devices;
+        for (int k = 0; same && k < devices; ++k) {
+            CellTower* tower = network.getTower(network.findCoreForDevice(ids[k]));
+            same = tower && tower->findDevice(ids[k]) != nullptr;
+        }
+
+        int least = devices;
+        int most = 0;
+        int total = 0;
+        for (int c = 0; c < network.getCoreCount(); ++c) {
+            int count = network.getTower(c)->getDeviceCount();
+            if (count < least) least = count;
+            if (count > most) most = count;
+            total += count;
+        }
+        same = same && total == devices;
+        if (POLICIES[p] != BalancingPolicy::HASHED) same = same && most - least <= 1;
+
+        delete[] ids;
+        delete[] types;
+        cases++;
+        failures += !same;
+    }
+    return verdict(name, "balancing", cases, failures);
+}
+
+static int runVerify(const CommunicationProtocol* const* protocols, const char* const* names, int count) {
+    bool ok = verifySpatial();
+    for (int p = 0; p < count; ++p) {
+        ok = verifyBatch(names[p], protocols[p]) && ok;
+        ok = verifySnapshot(names[p], protocols[p]) && ok;
+        int cores = protocols[p]->calculateRequiredCores();
+        ok = verifyBalancing(names[p], protocols[p], cores > 3 ? cores : 3) && ok;
+    }
+    // Four towers' worth of users over two cores: only moving on fills them both.
+    CustomProtocol large(2000, 1, 200);
+    ok = verifyBalancing("custom_large", &large, 2) && ok;
+    return ok ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (sameText(arg, "--quick")) {
+            quickMode = true;
+        } else if (sameText(arg, "--verify")) {
+            verifyMode = true;
+        } else {
+            io.errorstring("Usage: benchmark [--quick | --verify]\n");
+            return 1;
+        }
+    }
+
+    io.outputstring("bench-suite version=1 quick="); io.outputint(quickMode ? 1 : 0);
+    io.outputstring(" hardware_threads="); io.outputint(ThreadPool::hardwareThreads());
+    io.terminate();
+
+    Protocol2G p2g;
+    Protocol3G p3g;
+    Protocol4G p4g;
+    Protocol5G p5g;
+    CustomProtocol custom(10, 5, 1000);
+    const CommunicationProtocol* protocols[] = { &p2g, &p3g, &p4g, &p5g, &custom };
+    const char* names[] = { "2G", "3G", "4G", "5G", "custom" };
+
+    if (verifyMode) {
+        int status = runVerify(protocols, names, 5);
+        io.flush();
+        return status;
+    }
+
+    bool haveCsv = writeCsv(CSV_PATH, quickMode ? CSV_ROWS / 10 : CSV_ROWS);
+
+    resetPeakRss();
+    benchOutput();
+    benchSpatial();
+    if (haveCsv) benchCsvParse();
+
+    for (int p = 0; p < 5; ++p) {
+        resetPeakRss();
+        benchTower(names[p], protocols[p]);
+        benchCore(names[p], protocols[p]);
+        benchEvents(names[p], protocols[p]);
+        if (haveCsv) benchCsvAttach(names[p], protocols[p]);
+        benchSnapshot(names[p], protocols[p]);
+    }
+
+    if (haveCsv) syscall3(SYS_UNLINK, (long)CSV_PATH, 0, 0);
+    io.flush();
+    return 0;
+}
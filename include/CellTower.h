@@ -5,31 +5,87 @@
 #ifndef CELL_TOWER_H
 #define CELL_TOWER_H
 
+#include "ChannelAllocator.h"
 #include "CommunicationProtocol.h"
+#include "DevicePool.h"
+#include "DeviceTable.h"
+#include "IdIndex.h"
 #include "UserDevice.h"
 
+/**
+ * @brief Min/max/mean/stddev of one per-channel count over a set of channels.
+ *
+ * Keeps the raw sums so summaries of several towers can be merged exactly.
+ */
+struct LoadSummary {
+    int channels = 0;
+    int min = 0;
+    int max = 0;
+    long long sum = 0;
+    long long sumSquares = 0;
+
+    double mean() const { return channels > 0 ? static_cast<double>(sum) / channels : 0.0; }
+    double stddev() const;
+    void merge(const LoadSummary& other);
+};
+
+/**
+ * @brief Occupancy of every usable channel of a tower (or of several towers).
+ *
+ * histogram[b] counts channels whose load is in the b-th tenth of the
+ * per-channel capacity; the last bucket holds only full channels.
+ */
+struct ChannelStats {
+    static constexpr int HISTOGRAM_BUCKETS = 11;
+
+    int capacity = 0;            ///< Users per channel
+    LoadSummary total;
+    LoadSummary voice;
+    LoadSummary data;
+    int emptyChannels = 0;
+    int fullChannels = 0;
+    int busiestTowerId = 0;      ///< Tower and channel index of the first channel at total.max
+    int busiestChannel = -1;
+    int histogram[HISTOGRAM_BUCKETS] = {0};
+
+    void merge(const ChannelStats& other);
+};
+
 /**
  * @brief Represents a cellular tower managing user devices and frequency allocation.
  *
- * Each tower uses a specific communication protocol and manages a fixed-size collection
- * of connected user devices. It allocates frequencies and tracks users per channel.
+ * Each tower uses a specific communication protocol and manages a collection of
+ * connected user devices sized to the protocol's capacity (capped at MAX_DEVICES).
+ * It allocates frequencies and tracks users per channel index.
+ * Channel frequencies are cached at construction and free capacity is tracked by a
+ * ChannelAllocator, so attaching or detaching a device never walks the channel list.
+ * Device attributes are stored column-wise in a DeviceTable indexed by id; removal
+ * swaps the last row into the vacated one. Callers see UserDevice handles, which
+ * live in a tower-owned DevicePool: slots are reused after removal and all of
+ * them are released together when the tower is destroyed.
  */
 class CellTower {
 public:
     static constexpr int MAX_DEVICES = 100000;
-    static constexpr int MAX_FREQ_KHZ = 100000;
 
 private:
     int towerId_;
     const CommunicationProtocol* protocol_;
-    UserDevice* devices_[MAX_DEVICES];
-    int deviceCount_;
-    int frequencyAllocation_[MAX_FREQ_KHZ + 1]; // frequency -> count of devices
+    int capacity_;
+    int* channelFrequency_;                     // channel index -> frequency in kHz
+    DeviceTable table_;                         // one row per attached device
+    UserDevice** devices_;                      // row -> handle, capacity_ slots
+    DevicePool devicePool_;                     // owns every handle in devices_
+    IdIndex deviceIndex_;                       // deviceId -> row
+    ChannelAllocator channels_;
+    AllocationPolicy policy_;
 
-    bool isFrequencyAtCapacity(int frequency) const;
+    int channelIndexOf(int frequency) const;
+    void attach(int deviceId, int channel, ConnectionType type);
 
 public:
-    CellTower(int towerId, const CommunicationProtocol* protocol);
+    /// @param maxDevices Further cap on capacity (the protocol's maximum and MAX_DEVICES still apply)
+    CellTower(int towerId, const CommunicationProtocol* protocol, int maxDevices = MAX_DEVICES);
     ~CellTower();
 
     CellTower(const CellTower&) = delete;
@@ -39,13 +95,64 @@ public:
 
     int getTowerId() const { return towerId_; }
     const CommunicationProtocol* getProtocol() const { return protocol_; }
-    int getDeviceCount() const { return deviceCount_; }
+    int getDeviceCount() const { return table_.getCount(); }
+    int getCapacity() const { return capacity_; }
+    int getChannelCount() const { return channels_.getChannelCount(); }
     int getUsersOnFrequency(int frequency) const;
     UserDevice* getDevice(int index) const;
+    UserDevice* findDevice(int deviceId) const;
+    bool hasDevice(int deviceId) const { return deviceIndex_.find(deviceId) >= 0; }
+
+    /// Id of the device in row index (0 .. getDeviceCount()-1), without a handle lookup.
+    int getDeviceId(int index) const { return table_.getId(index); }
+
+    /// Column storage of the attached devices, for sweeps.
+    const DeviceTable& getDeviceTable() const { return table_; }
 
-    bool addUserDevice(UserDevice* device);
+    /// Number of attached devices with the given connection type.
+    int countDevices(ConnectionType type) const { return table_.countType(type); }
+    AllocationPolicy getAllocationPolicy() const { return policy_; }
+    void setAllocationPolicy(AllocationPolicy policy) { policy_ = policy; }
+
+    /**
+     * @brief Occupancy statistics over all usable channels.
+     *
+     * Reads only per-channel arrays: the allocator's loads and the device
+     * table's voice counts. One branch-free pass fills the summaries (it
+     * vectorizes when per-channel loads stay below 65536), and a second, scalar
+     * pass finds the busiest channel and fills the histogram. Channels without
+     * a valid frequency are left out. Nothing is allocated.
+     */
+    ChannelStats getChannelStats() const;
+
+    /// Bytes owned by this tower (object plus device, index and channel tables).
+    long long getMemoryUsage() const;
+
+    /// Creates and attaches a device; returns false if the tower is full or the ID is taken.
+    bool addUserDevice(int deviceId, ConnectionType type);
+
+    /**
+     * @brief Attaches a batch of devices without per-row diagnostics.
+     *
+     * Rows whose ID is already attached are skipped; the batch stops early once the
+     * tower or its channels are full.
+     * @return Number of devices attached
+     */
+    int addUserDevices(const int* deviceIds, const ConnectionType* types, int count);
+    /// Detaches a device and recycles its pool slot; pointers to it become invalid.
     bool removeUserDevice(int deviceId);
-    bool allocateFrequency(UserDevice* device);
+
+    /**
+     * @brief Fills an empty tower with saved rows (see Snapshot).
+     *
+     * The columns are copied as they are and channel loads are recounted from
+     * them, so restored devices keep their channels and later allocations
+     * behave as if the rows had been attached one by one.
+     * @return false (leaving the tower empty) if the tower is not empty, the
+     *         rows exceed its capacity or a channel, or an id is invalid or repeated
+     */
+    bool restoreDevices(const int* deviceIds, const int* channels, const ConnectionType* types,
+                        const bool* connected, int count);
 };
 
 #endif // CELL_TOWER_H
@@ -7,27 +7,121 @@
 #define CELLULAR_CORE_H
 
 #include "CellTower.h"
+#include "IdIndex.h"
+#include "Instrumentation.h"
+#include "PayloadTable.h"
+#include "ThreadPool.h"
 
+/**
+ * @brief Queued message header (16 bytes).
+ *
+ * Payload text is stored once in the owning core's PayloadTable and referenced
+ * by id, so queue scans touch only these hot fields.
+ */
 struct Message {
-    int messageId;
+    unsigned int messageId;     ///< Low 32 bits of the core's lifetime sequence number
     int fromDeviceId;
     int toTowerId;
+    unsigned short payloadId;
     bool isVoice;
-    char payload[256];
 };
 
+static_assert(sizeof(Message) == 16, "Message header should stay 16 bytes");
+
+/**
+ * @brief Repeating voice:data traffic from a fixed set of senders, for generateBatch().
+ *
+ * Message k of the pattern (k = position, position + 1, ...) comes from
+ * senders[k % senderCount] and its class follows a cycle of voiceShare +
+ * dataShare messages in which the rarer class comes first: 3:1 gives
+ * data, voice, voice, voice and 1:3 gives voice, data, data, data. position
+ * advances with every generated message, so consecutive batches continue the
+ * same sequence.
+ */
+struct TrafficPattern {
+    int voiceShare = 1;
+    int dataShare = 3;
+    const int* senders = nullptr;  ///< Device ids (e.g. DeviceTable::ids())
+    int senderCount = 0;
+    int toTowerId = 0;
+    int voicePayload = 0;          ///< Interned payload ids
+    int dataPayload = 0;
+    long long position = 0;
+
+    /// The built-in mixes: 3:1 for voice-centric protocols (2G), 1:3 otherwise.
+    void setProtocolMix(bool voiceCentric) {
+        voiceShare = voiceCentric ? 3 : 1;
+        dataShare = voiceCentric ? 1 : 3;
+    }
+};
+
+/// Messages of each class produced by a generateBatch() call.
+struct TrafficCounts {
+    long long voice = 0;
+    long long data = 0;
+};
+
+/**
+ * @brief Central coordinator owning towers and a bounded ring-buffer message queue.
+ *
+ * Producers enqueue with generateMessage() and consumers drain with
+ * processPending()/processMessages() in any interleaving. A full queue applies
+ * back-pressure: generateMessage() returns false and the caller drains before
+ * retrying. Lifetime counters are 64-bit, so sustained runs never overflow them.
+ *
+ * With setWorkerThreads(n > 1), large batches are validated in parallel: the
+ * tower-grouped batch is cut into n contiguous shards whose per-worker tallies
+ * are summed afterwards, giving the same counts as the serial path.
+ */
 class CellularCore {
 public:
     static constexpr int MAX_TOWERS = 100;
-    static constexpr int MAX_MESSAGES = 100000;
+    static constexpr int MAX_MESSAGES = 100000; ///< Ring buffer capacity (messages in flight)
+    static constexpr int PARALLEL_THRESHOLD = 8192; ///< Smaller batches stay on the calling thread
 
 private:
     int coreId_;
     CellTower* towers_[MAX_TOWERS];
     int towerCount_;
+    IdIndex towerIndex_;        // towerId -> slot in towers_
     Message* messageQueue_;
-    int messageQueueSize_;
+    int queueHead_;             // ring index of the oldest pending message
+    int messageQueueSize_;      // pending messages
+    long long totalMessagesGenerated_;
     long long totalMessagesProcessed_;
+    long long totalMessagesFailed_;
+    long long totalMessagesRejected_;
+    long long reportedProcessed_; // totals at the last processMessages() report
+    long long reportedFailed_;
+    PayloadTable payloads_;
+    int* batchSlot_;            // per queued message: destination tower slot
+    int* batchOrder_;           // queue positions grouped by tower slot
+    int batchGroupStart_[MAX_TOWERS + 2];
+    ThreadPool* workerPool_;    // nullptr when single-threaded
+#ifdef SIM_INSTRUMENTATION
+    mutable CoreInstrumentation instrumentation_; // tower failures are tallied from const shards
+    unsigned long long* enqueueTicks_; // ring-aligned with messageQueue_
+#endif
+
+    struct alignas(64) ShardTally {
+        long long success;
+        long long failure;
+    };
+    struct ShardJob {
+        const CellularCore* core;
+        int count;
+        int shards;
+        ShardTally* tallies;
+    };
+    static void processShard(int shard, void* context);
+    void tallyRange(int begin, int end, long long& success, long long& failure) const;
+
+    int resolveTowerSlot(int towerId) const { return towerIndex_.find(towerId); }
+    int ringIndex(int position) const {
+        int index = queueHead_ + position;
+        return index >= MAX_MESSAGES ? index - MAX_MESSAGES : index;
+    }
+    void groupPending(int count, int* order, int* groupStart);  // fills batchSlot_
 
 public:
     CellularCore(int coreId);
@@ -40,11 +134,88 @@ public:
 
     bool addCellTower(CellTower* tower);
     CellTower* getCellTower(int towerId) const;
+
+    /// Tower in registration order (0 .. getTowerCount()-1).
+    CellTower* getTowerAt(int index) const { return index >= 0 && index < towerCount_ ? towers_[index] : nullptr; }
     bool generateMessage(int fromDeviceId, int toTowerId, bool isVoice, const char* payload = "");
+
+    /// Enqueues a message whose payload was interned beforehand with internPayload().
+    bool generateMessage(int fromDeviceId, int toTowerId, bool isVoice, int payloadId);
+
+    /**
+     * @brief Enqueues up to count messages of pattern in one pass.
+     *
+     * Messages are written straight into the ring (at most two contiguous
+     * runs) with the same ids and fields generateMessage() would give them,
+     * but the queue-space and payload checks are made once per batch. The
+     * batch stops when the queue is full instead of rejecting messages: drain
+     * with processPending() and call again, since pattern.position has moved
+     * past the messages already enqueued.
+     *
+     * @return Voice and data messages enqueued (both 0 for an invalid pattern)
+     */
+    TrafficCounts generateBatch(TrafficPattern& pattern, long long count);
+
+    /// Returns a reusable payload id for text, or -1 if the payload table is full.
+    int internPayload(const char* text) { return payloads_.intern(text); }
+    const char* getPayload(const Message& msg) const { return payloads_.get(msg.payloadId); }
+    int getPayloadCount() const { return payloads_.getCount(); }
+    const char* getPayloadText(int payloadId) const { return payloads_.get(payloadId); }
+
+    /// Pending message at position (0 = oldest, < getQueueSize()).
+    const Message& getQueuedMessage(int position) const { return messageQueue_[ringIndex(position)]; }
+
+    /**
+     * @brief Groups the queued messages by destination tower.
+     *
+     * Each distinct toTowerId is resolved once per run of equal ids. On return,
+     * order[groupStart[t] .. groupStart[t+1]) holds the queue positions of messages
+     * bound for the t-th registered tower (t < getTowerCount()); the final group,
+     * t == getTowerCount(), holds messages whose tower is unknown. Not const:
+     * the destination slots are staged in the core's scratch buffer.
+     *
+     * @param order      Array of at least getQueueSize() entries
+     * @param groupStart Array of at least getTowerCount() + 2 entries
+     */
+    void groupMessagesByTower(int* order, int* groupStart);
+
+    /**
+     * @brief Consumes up to maxMessages of the oldest pending messages without printing.
+     * @return Number of messages consumed (successful or failed)
+     */
+    int processPending(int maxMessages);
+
+    /// Drains the queue and reports successes/failures since the previous report.
     void processMessages();
 
+    /**
+     * @brief Replaces an empty queue and the lifetime counters with saved values.
+     *
+     * Payload ids in messages must already be interned (in the saved order).
+     * @return false if the queue is not empty, count exceeds MAX_MESSAGES or a
+     *         message names an unknown payload
+     */
+    bool restoreQueue(const Message* messages, int count, long long generated, long long processed,
+                      long long failed, long long rejected);
+
+    /// Number of threads used by processPending(); 1 (default) keeps it serial.
+    void setWorkerThreads(int threads);
+    int getWorkerThreads() const { return workerPool_ ? workerPool_->getThreadCount() : 1; }
+
+    /// Phase timers, latency histograms and per-tower counters; nullptr unless built with INSTRUMENT=1.
+    const CoreInstrumentation* getInstrumentation() const;
+    void resetInstrumentation();
+
+    /// Prints the instrumentation counters ("instr core=..." lines); no-op unless built with INSTRUMENT=1.
+    void dumpInstrumentation() const;
+
+    long long getTotalMessagesGenerated() const { return totalMessagesGenerated_; }
     long long getTotalMessagesProcessed() const { return totalMessagesProcessed_; }
+    long long getTotalMessagesFailed() const { return totalMessagesFailed_; }
+    long long getTotalMessagesRejected() const { return totalMessagesRejected_; }
     int getTowerCount() const { return towerCount_; }
+    int getQueueSize() const { return messageQueueSize_; }
+    bool isQueueFull() const { return messageQueueSize_ >= MAX_MESSAGES; }
 };
 
 #endif // CELLULAR_CORE_H
@@ -0,0 +1,153 @@
+/* CellularNetwork.h
+ * Runs several CellularCore instances side by side and balances devices across them.
+ * C++17
+ */
+#ifndef CELLULAR_NETWORK_H
+#define CELLULAR_NETWORK_H
+
+#include "CellularCore.h"
+#include "CommunicationProtocol.h"
+#include "IdIndex.h"
+
+/**
+ * @enum BalancingPolicy
+ * @brief How a new device is assigned to one of the network's cores.
+ */
+enum class BalancingPolicy {
+    ROUND_ROBIN,  ///< Cycle through cores in order
+    LEAST_LOADED, ///< Core with the fewest attached devices (lowest index on ties)
+    HASHED        ///< Stable hash of the device ID, independent of arrival order
+};
+
+/// Short lowercase name ("round-robin", "least-loaded", "hashed") for reports and batch options.
+inline const char* balancingName(BalancingPolicy policy) {
+    switch (policy) {
+    case BalancingPolicy::LEAST_LOADED: return "least-loaded";
+    case BalancingPolicy::HASHED: return "hashed";
+    default: return "round-robin";
+    }
+}
+
+/**
+ * @brief Per-core outcome of the last run().
+ */
+struct CoreStats {
+    int deviceCount;
+    long long messages;      ///< Messages generated on this core
+    long long voiceMessages;
+    long long processed;     ///< Successfully processed
+    long long failed;
+    long long elapsedNs;     ///< Wall time of this core's generate/process loop
+};
+
+/**
+ * @brief A group of cellular cores sized from CommunicationProtocol::calculateRequiredCores().
+ *
+ * Each core owns one tower using the shared protocol. Devices are spread over the
+ * cores by a BalancingPolicy (a device whose chosen core is full goes to the
+ * next core with room), and run() drives every core's traffic concurrently,
+ * one core per thread, recording throughput per core.
+ */
+class CellularNetwork {
+public:
+    static constexpr int MAX_CORES = 64;
+
+private:
+    const CommunicationProtocol* protocol_;
+    CellularCore* cores_[MAX_CORES];
+    CellTower* towers_[MAX_CORES];    // owned by the matching core
+    CoreStats stats_[MAX_CORES];
+    int coreCount_;
+    BalancingPolicy policy_;
+    int nextCore_;                    // round-robin cursor
+    IdIndex deviceCore_;              // deviceId -> core index
+    int deviceCount_;
+    int maxDevices_;
+
+    struct RunJob {
+        CellularNetwork* network;
+        long long totalMessages;
+        int voiceShare;
+        int dataShare;
+    };
+    static void runCore(int core, void* context);
+    int pickCore(int deviceId) const;
+    int attach(int deviceId, ConnectionType type);
+
+public:
+    /**
+     * @param protocol     Shared protocol (not owned)
+     * @param coreCount    Number of cores; clamped quietly to [1, MAX_CORES]
+     * @param firstTowerId Tower of core i gets id firstTowerId + i
+     * @param policy       Device-to-core balancing policy
+     */
+    CellularNetwork(const CommunicationProtocol* protocol, int coreCount, int firstTowerId,
+                    BalancingPolicy policy = BalancingPolicy::ROUND_ROBIN);
+    ~CellularNetwork();
+
+    CellularNetwork(const CellularNetwork&) = delete;
+    CellularNetwork& operator=(const CellularNetwork&) = delete;
+
+    int getCoreCount() const { return coreCount_; }
+    int getDeviceCount() const { return deviceCount_; }
+    int getMaxDevices() const { return maxDevices_; }
+    BalancingPolicy getPolicy() const { return policy_; }
+    CellularCore* getCore(int index) const;
+    CellTower* getTower(int index) const;
+    const CoreStats& getCoreStats(int index) const { return stats_[index]; }
+
+    /// Creates a device on the core chosen by the balancing policy.
+    bool addUserDevice(int deviceId, ConnectionType type);
+
+    /**
+     * @brief Attaches a batch of devices, balancing each row by policy.
+     *
+     * Duplicate IDs and rows no core has room for are skipped quietly; the batch stops
+     * once the network reaches getMaxDevices().
+     * @return Number of devices attached
+     */
+    int addUserDevices(const int* deviceIds, const ConnectionType* types, int count);
+
+    /// Writes every core's towers, devices and queue to path (see Snapshot).
+    bool saveSnapshot(const char* path) const;
+
+    /**
+     * @brief Restores a population saved by saveSnapshot() into this (empty) network.
+     *
+     * The network must be built with the same protocol and core count. Device
+     * ownership is re-indexed from the restored towers and the round-robin
+     * cursor continues after the last restored device.
+     * @return false if the snapshot cannot be loaded or does not fit
+     */
+    bool loadSnapshot(const char* path);
+
+    /// Core index that owns deviceId, or -1.
+    int findCoreForDevice(int deviceId) const { return deviceCore_.find(deviceId); }
+
+    /**
+     * @brief Generates and processes totalMessages across all cores concurrently.
+     *
+     * Messages are split across cores in proportion to their device counts. Each
+     * core enqueues its share with CellularCore::generateBatch(): message j comes
+     * from device j (mod device count) and the classes follow a voiceShare:dataShare
+     * cycle (see TrafficPattern).
+     *
+     * @param threads Worker threads; 0 uses min(cores, hardware threads)
+     */
+    void run(long long totalMessages, int voiceShare, int dataShare, int threads = 0);
+
+    long long getTotalProcessed() const;
+    long long getTotalFailed() const;
+
+    /// Messages generated by the last run(), and how many of them were voice.
+    long long getTotalMessages() const;
+    long long getTotalVoice() const;
+
+    /// Prints per-core throughput and the load imbalance of the last run().
+    void printReport() const;
+
+    /// Dumps every core's instrumentation; no-op unless built with INSTRUMENT=1.
+    void dumpInstrumentation() const;
+};
+
+#endif // CELLULAR_NETWORK_H
@@ -0,0 +1,91 @@
+/* ChannelAllocator.h
+ * Tracks per-channel load and finds channels with spare capacity.
+ * C++17
+ */
+#ifndef CHANNEL_ALLOCATOR_H
+#define CHANNEL_ALLOCATOR_H
+
+/**
+ * @enum AllocationPolicy
+ * @brief Strategy used to pick a channel for a newly attached device.
+ */
+enum class AllocationPolicy {
+    FIRST_FIT,   ///< Lowest-indexed channel with spare capacity
+    LEAST_LOADED ///< Channel with the fewest users (ties go to the lowest index)
+};
+
+/**
+ * @brief Channel load bookkeeping with O(log n) allocation and release.
+ *
+ * Channels with spare capacity are tracked twice: in a hierarchical bitmap
+ * (64-ary, one find-first-set per level) for first-fit, and in an indexed
+ * min-heap keyed by (load, channel) for least-loaded allocation.
+ */
+class ChannelAllocator {
+private:
+    static constexpr int MAX_LEVELS = 6;
+
+    int channelCount_;
+    int capacity_;
+    int* load_;                              ///< channel -> users on channel
+    bool* usable_;                           ///< false for channels that never accept users
+
+    unsigned long long* levels_[MAX_LEVELS]; ///< levels_[0] bit c set = channel c has room
+    int levelWords_[MAX_LEVELS];
+    int levelCount_;
+
+    int* heap_;                              ///< channels with room, ordered by (load, index)
+    int* heapPos_;                           ///< channel -> position in heap_, -1 if absent
+    int heapSize_;
+
+    bool hasRoom(int channel) const { return usable_[channel] && load_[channel] < capacity_; }
+    void setBit(int channel);
+    void clearBit(int channel);
+    int findFirstSet() const;
+
+    bool heapLess(int a, int b) const;
+    void heapSwap(int i, int j);
+    void siftUp(int pos);
+    void siftDown(int pos);
+    void heapInsert(int channel);
+    void heapRemove(int channel);
+
+public:
+    ChannelAllocator(int channelCount, int capacityPerChannel);
+    ~ChannelAllocator();
+
+    ChannelAllocator(const ChannelAllocator&) = delete;
+    ChannelAllocator& operator=(const ChannelAllocator&) = delete;
+
+    int getChannelCount() const { return channelCount_; }
+    int getCapacity() const { return capacity_; }
+    int getLoad(int channel) const;
+    bool isUsable(int channel) const { return channel >= 0 && channel < channelCount_ && usable_[channel]; }
+
+    /// Per-channel loads (getChannelCount() entries) and usable flags, for sweeps.
+    const int* loads() const { return load_; }
+    const bool* usableFlags() const { return usable_; }
+    long long getMemoryUsage() const;
+
+    /// Permanently removes a channel from allocation (e.g. invalid frequency).
+    void excludeChannel(int channel);
+
+    /// Reserves one slot on a channel chosen by policy; returns -1 if all are full.
+    int allocate(AllocationPolicy policy);
+
+    /// Returns one slot to a channel previously handed out by allocate().
+    void release(int channel);
+
+    /**
+     * @brief Replaces every channel's load with the number of rows naming it.
+     *
+     * Used to restore a saved tower without replaying allocate(): the loads are
+     * counted in one pass and the bitmap and heap rebuilt in O(channels).
+     * Nothing changes if a channel index is out of range, unusable or over
+     * capacity.
+     * @return false if rowChannels does not describe a valid allocation
+     */
+    bool restoreLoads(const int* rowChannels, int rows);
+};
+
+#endif // CHANNEL_ALLOCATOR_H
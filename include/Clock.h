@@ -0,0 +1,20 @@
+/* Clock.h
+ * Monotonic time source for throughput and latency measurements.
+ * C++17
+ */
+#ifndef CLOCK_H
+#define CLOCK_H
+
+/**
+ * @brief Thin wrapper over clock_gettime(CLOCK_MONOTONIC) issued via syscall.
+ */
+class Clock {
+public:
+    /// Monotonic time in nanoseconds (arbitrary epoch).
+    static long long nowNanoseconds();
+
+    /// events per second for a count observed over elapsedNs; 0 if elapsedNs <= 0.
+    static long long ratePerSecond(long long events, long long elapsedNs);
+};
+
+#endif // CLOCK_H
@@ -5,6 +5,8 @@
 #ifndef COMMUNICATION_PROTOCOL_H
 #define COMMUNICATION_PROTOCOL_H
 
+#include "QosPolicy.h"
+
 /**
  * @brief Abstract base class defining the interface for communication protocols.
  *
@@ -26,9 +28,13 @@ public:
     /// Returns number of frequency channels managed by protocol
     virtual int getChannelCount() const = 0;
 
-    /// Get channel by index (0 to getChannelCount()-1)
+    /// Get channel by index (0 to getChannelCount()-1); frequencies ascend with index
     virtual int getFrequencyChannel(int index) const = 0;
 
+    /// Messages one user slot generates per second; a channel serves
+    /// getUsersPerChannel() * getMessagesPerUser() messages per simulated second
+    virtual int getMessagesPerUser() const = 0;
+
     /// Calculate maximum supported users for the whole spectrum
     virtual int calculateMaxUsers() const = 0;
 
@@ -45,6 +51,9 @@ public:
      * @return Number of cores
      */
     virtual int calculateRequiredCores() const { return 1; }
+
+    /// How towers order waiting voice and data messages. Default is plain FIFO.
+    virtual QosPolicy getQosPolicy() const { return QosPolicy(); }
 };
 
 #endif // COMMUNICATION_PROTOCOL_H
@@ -16,6 +16,7 @@ private:
     int totalSpectrum_;
     int messagesPerUser_;
     double overheadPercent_;
+    QosPolicy qosPolicy_;
 
 public:
     CustomProtocol(int usersPerChannel, int channelBandwidth, int totalSpectrum)
@@ -23,7 +24,8 @@ public:
           channelBandwidth_(channelBandwidth), 
           totalSpectrum_(totalSpectrum),
           messagesPerUser_(10), // Default
-          overheadPercent_(0.0) {}
+          overheadPercent_(0.0),
+          qosPolicy_() {}
 
     const char* getName() const override { return "Custom Protocol"; }
     int getUsersPerChannel() const override { return usersPerChannel_; }
@@ -35,6 +37,8 @@ public:
         return index * channelBandwidth_;
     }
     
+    int getMessagesPerUser() const override { return messagesPerUser_; }
+
     int calculateMaxUsers() const override {
         return getChannelCount() * usersPerChannel_;
     }
@@ -45,6 +49,9 @@ public:
     }
     
     void setOverheadPercent(double percent) { overheadPercent_ = percent; }
+
+    QosPolicy getQosPolicy() const override { return qosPolicy_; }
+    void setQosPolicy(const QosPolicy& policy) { qosPolicy_ = policy; }
 };
 
 #endif // CUSTOM_PROTOCOL_H
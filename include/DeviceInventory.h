@@ -0,0 +1,62 @@
+/* DeviceInventory.h
+ * Bulk loader for CSV device inventories (deviceId,Type per line).
+ * C++17
+ */
+#ifndef DEVICE_INVENTORY_H
+#define DEVICE_INVENTORY_H
+
+#include "UserDevice.h"
+
+/**
+ * @brief Device IDs and connection types parsed from a CSV file.
+ *
+ * The file is memory-mapped and parsed in place with a hand-rolled field
+ * parser; large files are split at line boundaries and parsed on several
+ * threads. Malformed rows are skipped and their line numbers recorded
+ * (the first MAX_REPORTED_ERRORS of them) instead of aborting the load.
+ *
+ * Accepted row: [spaces] id [spaces] ',' [spaces] D|d|V|v [spaces], id > 0.
+ * Blank lines are ignored.
+ */
+class DeviceInventory {
+public:
+    static constexpr int MAX_REPORTED_ERRORS = 32;
+    static constexpr long long MIN_CHUNK_BYTES = 1 << 20; ///< Smaller files parse on one thread
+
+private:
+    int* ids_;
+    ConnectionType* types_;
+    int count_;
+    long long badRowCount_;
+    long long badRowLines_[MAX_REPORTED_ERRORS];
+    int badRowsStored_;
+
+    struct Chunk;
+    static void parseChunk(int index, void* context);
+    void clear();
+
+public:
+    DeviceInventory();
+    ~DeviceInventory();
+
+    DeviceInventory(const DeviceInventory&) = delete;
+    DeviceInventory& operator=(const DeviceInventory&) = delete;
+
+    /**
+     * @brief Replaces the inventory with the rows of path.
+     * @param threads Parser threads; 0 uses the hardware thread count
+     * @return false if the file could not be opened or mapped
+     */
+    bool loadFile(const char* path, int threads = 0);
+
+    int getCount() const { return count_; }
+    const int* getIds() const { return ids_; }
+    const ConnectionType* getTypes() const { return types_; }
+
+    long long getBadRowCount() const { return badRowCount_; }
+    /// 1-based line numbers of the first getReportedBadRows() malformed rows, in file order.
+    int getReportedBadRows() const { return badRowsStored_; }
+    long long getBadRowLine(int index) const { return badRowLines_[index]; }
+};
+
+#endif // DEVICE_INVENTORY_H
@@ -0,0 +1,59 @@
+/* DevicePool.h
+ * Slab allocator for UserDevice objects.
+ * C++17
+ */
+#ifndef DEVICE_POOL_H
+#define DEVICE_POOL_H
+
+#include "UserDevice.h"
+
+/**
+ * @brief Hands out UserDevice handles from contiguous slabs instead of the heap.
+ *
+ * Slots are carved from slabs of a fixed slot count in address order; released
+ * slots go on a free list and are reused (most recently freed first) before the
+ * pool touches a new slot. All slabs are freed at once by clear() or the destructor,
+ * so live devices must not be used after that.
+ */
+class DevicePool {
+public:
+    static constexpr int DEFAULT_SLAB_SLOTS = 4096;
+
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(UserDevice) unsigned char storage[sizeof(UserDevice)];
+    };
+
+    int slabSlots_;
+    Slot** slabs_;
+    int slabCount_;
+    int slabCapacity_;
+    int usedInLastSlab_;     // bump cursor into slabs_[slabCount_ - 1]
+    Slot* freeList_;
+    int liveCount_;
+
+    Slot* takeSlot();
+
+public:
+    explicit DevicePool(int slabSlots = DEFAULT_SLAB_SLOTS);
+    ~DevicePool();
+
+    DevicePool(const DevicePool&) = delete;
+    DevicePool& operator=(const DevicePool&) = delete;
+
+    int getLiveCount() const { return liveCount_; }
+    int getSlabCount() const { return slabCount_; }
+    long long getMemoryUsage() const;
+
+    /// Constructs a handle to a DeviceTable row in a pooled slot.
+    UserDevice* create(DeviceTable* table, int row);
+
+    /// Returns a device created by this pool to the free list.
+    void release(UserDevice* device);
+
+    /// Frees every slab in one step; all devices from this pool become invalid.
+    void clear();
+};
+
+#endif // DEVICE_POOL_H
@@ -0,0 +1,80 @@
+/* DeviceTable.h
+ * Structure-of-arrays storage for the devices attached to one tower.
+ * C++17
+ */
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include "UserDevice.h"
+
+/**
+ * @brief Parallel arrays of device id, channel index, connection type and
+ *        connected flag, one row per attached device.
+ *
+ * Rows are dense (0 .. getCount()-1); removing a row moves the last row into
+ * its place. Sweeps over a single attribute touch one contiguous array. The
+ * table also keeps the number of voice rows per channel up to date, so
+ * per-channel class breakdowns never have to scan the rows.
+ */
+class DeviceTable {
+private:
+    int capacity_;
+    int count_;
+    int* ids_;
+    int* channels_;                 ///< index into channelFrequency_
+    ConnectionType* types_;
+    bool* connected_;
+    const int* channelFrequency_;   ///< channel index -> kHz (owned by the tower)
+    int channelCount_;
+    int* channelVoice_;             ///< channel index -> voice rows on it
+
+public:
+    DeviceTable(int capacity, const int* channelFrequency, int channelCount);
+    ~DeviceTable();
+
+    DeviceTable(const DeviceTable&) = delete;
+    DeviceTable& operator=(const DeviceTable&) = delete;
+
+    int getCount() const { return count_; }
+    int getCapacity() const { return capacity_; }
+    long long getMemoryUsage() const;
+
+    int getId(int row) const { return ids_[row]; }
+    int getChannel(int row) const { return channels_[row]; }
+    int getFrequency(int row) const { return channelFrequency_[channels_[row]]; }
+    ConnectionType getType(int row) const { return types_[row]; }
+    bool isConnected(int row) const { return connected_[row]; }
+
+    void setType(int row, ConnectionType type);
+    void setConnected(int row, bool connected) { connected_[row] = connected; }
+
+    /// Column views for linear sweeps (getCount() entries each).
+    const int* ids() const { return ids_; }
+    const int* channels() const { return channels_; }
+    const ConnectionType* types() const { return types_; }
+    const bool* connected() const { return connected_; }
+
+    /// Voice rows per channel (channelCount entries).
+    const int* channelVoiceCounts() const { return channelVoice_; }
+
+    /// Appends a connected row and returns its index (caller checks capacity).
+    int append(int deviceId, int channel, ConnectionType type);
+
+    /// Replaces all rows with count rows copied column by column (count <= capacity).
+    void assign(const int* ids, const int* channels, const ConnectionType* types,
+                const bool* connected, int count);
+
+    /// Moves the last row into row and shrinks the table by one.
+    void removeRow(int row);
+
+    /// Number of rows with the given connection type.
+    int countType(ConnectionType type) const;
+
+    /// Number of rows currently flagged as connected.
+    int countConnected() const;
+
+    /// Sets every row's connected flag.
+    void setAllConnected(bool connected);
+};
+
+#endif // DEVICE_TABLE_H
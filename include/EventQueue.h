@@ -0,0 +1,58 @@
+/* EventQueue.h
+ * Min-heap of timestamped events for discrete-event simulation.
+ * C++17
+ */
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+/**
+ * @brief A scheduled event: when it fires and what it refers to.
+ *
+ * Events with equal times fire in scheduling order (sequence breaks ties), so
+ * runs are reproducible.
+ */
+struct Event {
+    long long time;          ///< Simulated time in nanoseconds
+    unsigned int sequence;   ///< Scheduling order, for stable ties
+    int target;              ///< Caller-defined (e.g. tower index and event kind)
+};
+
+/**
+ * @brief Binary min-heap of events ordered by (time, sequence).
+ *
+ * Entries are 16 bytes and stored in one growable array; push and pop are
+ * O(log n) in the number of pending events.
+ */
+class EventQueue {
+private:
+    Event* heap_;
+    int size_;
+    int capacity_;
+    unsigned int nextSequence_;
+
+    static bool earlier(const Event& a, const Event& b) {
+        if (a.time != b.time) return a.time < b.time;
+        return static_cast<int>(a.sequence - b.sequence) < 0; // wrap-safe
+    }
+    void grow();
+
+public:
+    explicit EventQueue(int expectedEvents = 64);
+    ~EventQueue();
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    bool empty() const { return size_ == 0; }
+    int size() const { return size_; }
+    const Event& top() const { return heap_[0]; }
+
+    void push(long long time, int target);
+
+    /// Removes and returns the earliest event (queue must not be empty).
+    Event pop();
+
+    void clear() { size_ = 0; }
+};
+
+#endif // EVENT_QUEUE_H
@@ -0,0 +1,133 @@
+/* EventSimulator.h
+ * Discrete-event model of message arrivals and channel service over simulated time.
+ * C++17
+ */
+#ifndef EVENT_SIMULATOR_H
+#define EVENT_SIMULATOR_H
+
+#include "CellTower.h"
+#include "EventQueue.h"
+#include "Instrumentation.h"
+#include "QosPolicy.h"
+
+/**
+ * @brief Parameters of an event-driven run.
+ */
+struct EventConfig {
+    long long durationNs = 0;      ///< Simulated time horizon
+    double arrivalRate = 1.0;      ///< Messages per second per attached device
+    double voiceFraction = 0.25;   ///< Share of arrivals that are voice
+    double serviceRate = 0.0;      ///< Messages per second per channel; 0 = protocol-derived
+    int queueLimit = 0;            ///< Waiting messages per class per tower; 0 = tower capacity
+    const QosPolicy* qos = nullptr; ///< Scheduling for every tower; nullptr = each protocol's getQosPolicy()
+    unsigned long long seed = 1;
+};
+
+/**
+ * @brief Counters of an event-driven run (per tower or aggregated).
+ */
+struct EventStats {
+    long long events = 0;          ///< Events handled (arrivals + departures)
+    long long arrivals = 0;
+    long long voiceArrivals = 0;
+    long long served = 0;          ///< Services completed within the horizon
+    long long voiceServed = 0;
+    long long dropped = 0;         ///< Arrivals rejected by a full queue
+    long long voiceDropped = 0;
+    long long backlog = 0;         ///< Waiting or in service at the horizon
+    long long busyNs = 0;          ///< Channel-time spent serving, summed over channels
+    long long capacityNs = 0;      ///< Channels x horizon
+    long long simulatedNs = 0;     ///< The horizon (for per-second rates)
+    long long wallNs = 0;          ///< Real time taken by run()
+    LatencyHistogram voiceWait;    ///< Queueing delay (arrival to service start)
+    LatencyHistogram dataWait;
+
+    /// Busy share of channel time in parts per thousand.
+    int utilizationPermille() const {
+        return capacityNs > 0 ? static_cast<int>(busyNs * 1000 / capacityNs) : 0;
+    }
+};
+
+/**
+ * @brief Simulates towers as multi-server queues driven by an EventQueue.
+ *
+ * Each tower receives a Poisson stream of messages at arrivalRate times its
+ * device count (the superposition of its devices' streams), split into voice
+ * and data by voiceFraction. Every channel is a server that holds a message for
+ * a fixed 1 / serviceRate seconds; by default a channel serves
+ * getUsersPerChannel() * getMessagesPerUser() messages per second. Arrivals
+ * that find every channel busy wait in per-class (voice, data) FIFO rings of
+ * queueLimit entries each, so a data burst cannot crowd voice out of the
+ * buffer; an arrival is dropped when its class's ring is full. When
+ * a channel frees up, the tower's QosPolicy picks the class to serve:
+ *
+ *  - FIFO: the older of the two queue heads
+ *  - STRICT_PRIORITY: voice whenever voice is waiting
+ *  - WEIGHTED_FAIR: self-clocked fair queueing; each message is stamped with a
+ *    virtual finish tag max(V, class's last tag) + 1/weight, where V is the tag
+ *    of the last message put into service, and the smaller head tag goes first
+ *
+ * Time only advances from event to event, so cost is proportional to the
+ * number of messages, not to the simulated duration.
+ */
+class EventSimulator {
+private:
+    // Class index into the per-class arrays below.
+    static constexpr int DATA = 0;
+    static constexpr int VOICE = 1;
+
+    struct Waiting {
+        long long arrivalNs;
+        long long tag;       ///< virtual finish tag (WEIGHTED_FAIR)
+    };
+
+    struct TowerState {
+        int channels;
+        int busy;
+        double arrivalsPerNs;
+        long long serviceNs;
+        QosPolicy qos;
+        Waiting* queue[2];   ///< per-class ring buffers of queueLimit entries
+        int queueHead[2];
+        int queueSize[2];
+        int queueLimit;      ///< per class
+        long long tagCost[2];   ///< virtual-time cost of one message (inverse weight)
+        long long lastTag[2];
+        long long virtualTime;
+        EventStats stats;
+    };
+
+    TowerState* towers_;
+    int towerCount_;
+    EventConfig config_;
+    EventQueue events_;
+    EventStats total_;
+    unsigned long long rng_;
+
+    double nextUniform();
+    long long nextGap(double ratePerNs);
+    void arrive(int tower, long long now);
+    void depart(int tower, bool wasVoice, long long now);
+    void startService(TowerState& t, long long now, long long arrivalNs, bool isVoice);
+    int pickClass(const TowerState& t) const;
+
+public:
+    /// towers are read (device and channel counts, protocol) but not modified.
+    EventSimulator(CellTower* const* towers, int towerCount, const EventConfig& config);
+    ~EventSimulator();
+
+    EventSimulator(const EventSimulator&) = delete;
+    EventSimulator& operator=(const EventSimulator&) = delete;
+
+    /// Runs from time 0 to config.durationNs; may be called once.
+    void run();
+
+    int getTowerCount() const { return towerCount_; }
+    const EventStats& getStats() const { return total_; }
+    const EventStats& getTowerStats(int index) const { return towers_[index].stats; }
+
+    /// Prints the human-readable queueing report.
+    void printReport() const;
+};
+
+#endif // EVENT_SIMULATOR_H
@@ -0,0 +1,53 @@
+/* IdIndex.h
+ * Open-addressing hash map from integer ids to array slots.
+ * C++17
+ */
+#ifndef ID_INDEX_H
+#define ID_INDEX_H
+
+/**
+ * @brief Maps integer ids (device ids, tower ids, ...) to non-negative slot indices.
+ *
+ * Linear probing over power-of-two tables kept at most half full; erase uses
+ * backward-shift deletion, so no tombstones accumulate under churn.
+ */
+class IdIndex {
+private:
+    int* keys_;
+    int* values_;   ///< -1 marks an empty bucket
+    int capacity_;
+    int shift_;
+    int size_;
+
+    int bucketOf(int key) const {
+        return static_cast<int>((static_cast<unsigned int>(key) * 2654435761u) >> shift_);
+    }
+    void allocate(int capacity);
+    void grow();
+
+public:
+    explicit IdIndex(int expectedEntries = 16);
+    ~IdIndex();
+
+    IdIndex(const IdIndex&) = delete;
+    IdIndex& operator=(const IdIndex&) = delete;
+
+    int size() const { return size_; }
+    long long getMemoryUsage() const { return static_cast<long long>(capacity_) * 2 * sizeof(int); }
+
+    /// Returns the slot stored for key, or -1 if absent.
+    int find(int key) const;
+
+    /// Adds key -> value (value >= 0); returns false if key is already present.
+    bool insert(int key, int value);
+
+    /// Changes the slot of an existing key; returns false if key is absent.
+    bool update(int key, int value);
+
+    /// Removes key; returns false if key is absent.
+    bool erase(int key);
+
+    void clear();
+};
+
+#endif // ID_INDEX_H
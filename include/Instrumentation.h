@@ -0,0 +1,150 @@
+/* Instrumentation.h
+ * Optional hot-path timers, latency histograms and per-tower counters.
+ * C++17
+ */
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+/*
+ * Instrumentation is compiled in only when SIM_INSTRUMENTATION is defined
+ * (`make INSTRUMENT=1`). Without it, SIM_INSTR(...) expands to nothing and
+ * CellularCore carries no extra members, so the default build pays nothing.
+ */
+#ifdef SIM_INSTRUMENTATION
+#define SIM_INSTRUMENTATION_ENABLED 1
+#define SIM_INSTR(statement) statement
+#else
+#define SIM_INSTRUMENTATION_ENABLED 0
+#define SIM_INSTR(statement)
+#endif
+
+/**
+ * @brief Cheap timestamps from the CPU time-stamp counter.
+ *
+ * Reading the counter costs a few cycles instead of a clock_gettime syscall;
+ * tick counts are converted to nanoseconds with a ratio calibrated once
+ * against Clock.
+ */
+class Ticks {
+public:
+    static unsigned long long now() { return __builtin_ia32_rdtsc(); }
+
+    /// Nanoseconds per tick (calibrated on first use, thread-safe).
+    static double nanosecondsPerTick();
+
+    static long long toNanoseconds(unsigned long long ticks) {
+        return static_cast<long long>(static_cast<double>(ticks) * nanosecondsPerTick());
+    }
+};
+
+/**
+ * @brief Latency distribution in power-of-two buckets.
+ *
+ * Bucket b holds samples in [2^(b-1), 2^b) ns (bucket 0 holds 0 ns), so 48
+ * buckets cover everything up to ~39 hours with at most 2x error per sample.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 48;
+
+private:
+    long long counts_[BUCKETS];
+    long long count_;
+    long long sumNs_;
+    long long minNs_;
+    long long maxNs_;
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset();
+    void record(long long ns);
+    void merge(const LatencyHistogram& other);
+
+    long long getCount() const { return count_; }
+    long long getMin() const { return count_ > 0 ? minNs_ : 0; }
+    long long getMax() const { return maxNs_; }
+    long long getMean() const { return count_ > 0 ? sumNs_ / count_ : 0; }
+    long long getBucketCount(int bucket) const { return counts_[bucket]; }
+
+    /// Upper bound (ns) of bucket b.
+    static long long bucketLimit(int bucket) { return bucket == 0 ? 1 : (1LL << bucket); }
+
+    /// Upper bucket bound at or above the given quantile, in parts per thousand.
+    long long percentile(int permille) const;
+};
+
+/**
+ * @enum Phase
+ * @brief Timed stages of a core's message pipeline.
+ */
+enum class Phase {
+    GENERATION,   ///< generateMessage(): enqueueing a message
+    ROUTING,      ///< Grouping a batch by destination tower
+    TOWER_LOOKUP, ///< Validating senders against their towers
+    COUNT
+};
+
+/**
+ * @brief One core's instrumentation state: phase timers, per-class latency
+ *        histograms (queue wait from generation to processing) and per-tower
+ *        message/failure counters.
+ */
+class CoreInstrumentation {
+public:
+    static constexpr int PHASES = static_cast<int>(Phase::COUNT);
+
+private:
+    struct PhaseTimer {
+        unsigned long long ticks;
+        long long calls;
+        long long items;
+    };
+
+    PhaseTimer phases_[PHASES];
+    LatencyHistogram voice_;
+    LatencyHistogram data_;
+    int towerSlots_;
+    long long* towerMessages_;   ///< per tower slot; slot towerSlots_ = unknown tower
+    long long* towerFailures_;
+
+public:
+    /// @param towerSlots Number of tower slots; counters for unknown towers use slot towerSlots
+    explicit CoreInstrumentation(int towerSlots);
+    ~CoreInstrumentation();
+
+    CoreInstrumentation(const CoreInstrumentation&) = delete;
+    CoreInstrumentation& operator=(const CoreInstrumentation&) = delete;
+
+    void reset();
+
+    void addPhase(Phase phase, unsigned long long ticks, long long items) {
+        PhaseTimer& timer = phases_[static_cast<int>(phase)];
+        timer.ticks += ticks;
+        timer.calls++;
+        timer.items += items;
+    }
+
+    void recordLatency(bool isVoice, long long ns) { (isVoice ? voice_ : data_).record(ns); }
+
+    void addTowerMessages(int slot, long long messages) { towerMessages_[slot] += messages; }
+
+    /// Safe to call from several shards at once.
+    void addTowerFailures(int slot, long long failures) {
+        __atomic_fetch_add(&towerFailures_[slot], failures, __ATOMIC_RELAXED);
+    }
+
+    long long getPhaseNanoseconds(Phase phase) const;
+    long long getPhaseItems(Phase phase) const { return phases_[static_cast<int>(phase)].items; }
+    const LatencyHistogram& getLatency(bool isVoice) const { return isVoice ? voice_ : data_; }
+    long long getTowerMessages(int slot) const { return towerMessages_[slot]; }
+    long long getTowerFailures(int slot) const { return towerFailures_[slot]; }
+
+    /**
+     * @brief Prints every counter as "instr core=<id> ..." key=value lines.
+     * @param towerIds Tower id per slot (towerCount entries); unknown-tower traffic is reported as tower=unknown
+     */
+    void dump(int coreId, const int* towerIds, int towerCount) const;
+};
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,53 @@
+/* PayloadTable.h
+ * Interned message payload storage for the cellular core.
+ * C++17
+ */
+#ifndef PAYLOAD_TABLE_H
+#define PAYLOAD_TABLE_H
+
+/**
+ * @brief Stores each distinct payload string once and hands out small integer ids.
+ *
+ * Payload bytes live back-to-back (NUL-terminated) in a bump-allocated arena;
+ * an open-addressing table maps string contents to ids. Id 0 is always the
+ * empty payload. Pointers returned by get() stay valid until the next intern()
+ * that adds a new string.
+ */
+class PayloadTable {
+public:
+    static constexpr int MAX_PAYLOADS = 65536;
+    static constexpr int MAX_PAYLOAD_LENGTH = 255;
+
+private:
+    char* arena_;
+    int arenaSize_;
+    int arenaCapacity_;
+    int* offsets_;        ///< id -> arena offset
+    int* lengths_;        ///< id -> byte length (excluding NUL)
+    int count_;
+    int entryCapacity_;
+    int* buckets_;        ///< hash bucket -> id, -1 if empty
+    int bucketCapacity_;
+
+    static unsigned int hash(const char* text, int len);
+    bool equals(int id, const char* text, int len) const;
+    void growEntries();
+    void growBuckets();
+
+public:
+    PayloadTable();
+    ~PayloadTable();
+
+    PayloadTable(const PayloadTable&) = delete;
+    PayloadTable& operator=(const PayloadTable&) = delete;
+
+    /// Returns the id for text (truncated to MAX_PAYLOAD_LENGTH), or -1 if the table is full.
+    int intern(const char* text);
+
+    const char* get(int id) const;
+    int getLength(int id) const;
+    int getCount() const { return count_; }
+    long long getMemoryUsage() const;
+};
+
+#endif // PAYLOAD_TABLE_H
@@ -9,7 +9,7 @@
 /**
  * @brief 3G (CDMA) protocol implementation.
  */
-class Protocol3G : public CommunicationProtocol {
+class Protocol3G final : public CommunicationProtocol {
 public:
     static constexpr int USERS_PER_200KHZ = 32;
     static constexpr int CHANNEL_BANDWIDTH_KHZ = 200;
@@ -17,13 +17,28 @@ public:
     static constexpr int MESSAGES_PER_USER = 10; // combined data + voice
     static constexpr double OVERHEAD_PERCENT = 8.0; // percent per 100 messages
 
+    // Derived plan, usable at compile time (see ProtocolTraits.h)
+    static constexpr int USERS_PER_CHANNEL = USERS_PER_200KHZ;
+    static constexpr int CHANNEL_COUNT = TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
+    static constexpr int MAX_USERS = CHANNEL_COUNT * USERS_PER_CHANNEL;
+    static constexpr int REQUIRED_CORES = 1;
+    static constexpr bool VOICE_CENTRIC = false;
+    static constexpr int BAND_OFFSET_KHZ = 0;
+
+    // Voice/data scheduling: conversational class ahead of background data
+    static constexpr QueueDiscipline QOS_DISCIPLINE = QueueDiscipline::STRICT_PRIORITY;
+    static constexpr int QOS_VOICE_WEIGHT = 1;
+    static constexpr int QOS_DATA_WEIGHT = 1;
+
     const char* getName() const override;
     int getUsersPerChannel() const override;
     int getChannelBandwidth() const override;
     int getChannelCount() const override;
     int getFrequencyChannel(int index) const override;
+    int getMessagesPerUser() const override;
     int calculateMaxUsers() const override;
     int calculateOverhead(int totalMessages) const override;
+    QosPolicy getQosPolicy() const override;
 };
 
 #endif // PROTOCOL_3G_H
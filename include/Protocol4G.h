@@ -9,7 +9,7 @@
 /**
  * @brief 4G (OFDM) protocol implementation.
  */
-class Protocol4G : public CommunicationProtocol {
+class Protocol4G final : public CommunicationProtocol {
 public:
     static constexpr int USERS_PER_10KHZ = 30;
     static constexpr int CHANNEL_BANDWIDTH_KHZ = 10;
@@ -19,13 +19,28 @@ public:
     static constexpr double OVERHEAD_PERCENT = 5.0;
     static constexpr int USERS_PER_CORE = 1000;
 
+    // Derived plan, usable at compile time (see ProtocolTraits.h)
+    static constexpr int USERS_PER_CHANNEL = USERS_PER_10KHZ * ANTENNAS;
+    static constexpr int CHANNEL_COUNT = TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
+    static constexpr int MAX_USERS = CHANNEL_COUNT * USERS_PER_CHANNEL;
+    static constexpr int REQUIRED_CORES = (MAX_USERS + USERS_PER_CORE - 1) / USERS_PER_CORE;
+    static constexpr bool VOICE_CENTRIC = false;
+    static constexpr int BAND_OFFSET_KHZ = 0;
+
+    // Voice/data scheduling: VoLTE-style bearer weighting
+    static constexpr QueueDiscipline QOS_DISCIPLINE = QueueDiscipline::WEIGHTED_FAIR;
+    static constexpr int QOS_VOICE_WEIGHT = 4;
+    static constexpr int QOS_DATA_WEIGHT = 1;
+
     const char* getName() const override;
     int getUsersPerChannel() const override;
     int getChannelBandwidth() const override;
     int getChannelCount() const override;
     int getFrequencyChannel(int index) const override;
+    int getMessagesPerUser() const override;
     int calculateMaxUsers() const override;
     int calculateOverhead(int totalMessages) const override;
+    QosPolicy getQosPolicy() const override;
 
     int calculateRequiredCores() const override;
 };
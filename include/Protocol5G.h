@@ -9,7 +9,7 @@
 /**
  * @brief 5G (Massive MIMO at 1800 MHz) protocol implementation.
  */
-class Protocol5G : public CommunicationProtocol {
+class Protocol5G final : public CommunicationProtocol {
 public:
     static constexpr int FREQUENCY_BAND_MHZ = 1800;
     static constexpr int USERS_PER_1MHZ = 30;
@@ -20,13 +20,28 @@ public:
     static constexpr double OVERHEAD_PERCENT = 3.0;
     static constexpr int USERS_PER_CORE = 2000;
 
+    // Derived plan, usable at compile time (see ProtocolTraits.h)
+    static constexpr int USERS_PER_CHANNEL = USERS_PER_1MHZ * ANTENNAS;
+    static constexpr int CHANNEL_COUNT = TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
+    static constexpr int MAX_USERS = CHANNEL_COUNT * USERS_PER_CHANNEL;
+    static constexpr int REQUIRED_CORES = (MAX_USERS + USERS_PER_CORE - 1) / USERS_PER_CORE;
+    static constexpr bool VOICE_CENTRIC = false;
+    static constexpr int BAND_OFFSET_KHZ = FREQUENCY_BAND_MHZ * 1000;
+
+    // Voice/data scheduling: VoLTE-style bearer weighting
+    static constexpr QueueDiscipline QOS_DISCIPLINE = QueueDiscipline::WEIGHTED_FAIR;
+    static constexpr int QOS_VOICE_WEIGHT = 4;
+    static constexpr int QOS_DATA_WEIGHT = 1;
+
     const char* getName() const override;
     int getUsersPerChannel() const override;
     int getChannelBandwidth() const override;
     int getChannelCount() const override;
     int getFrequencyChannel(int index) const override;
+    int getMessagesPerUser() const override;
     int calculateMaxUsers() const override;
     int calculateOverhead(int totalMessages) const override;
+    QosPolicy getQosPolicy() const override;
 
     int calculateRequiredCores() const override;
 };
@@ -0,0 +1,47 @@
+/* ProtocolTraits.h
+ * Compile-time view of a protocol's channel plan and traffic mix.
+ * C++17
+ */
+#ifndef PROTOCOL_TRAITS_H
+#define PROTOCOL_TRAITS_H
+
+#include "CustomProtocol.h"
+
+/**
+ * @brief Uniform access to a protocol's parameters for templated code.
+ *
+ * For the built-in protocols (Protocol2G .. Protocol5G) every value is a
+ * constant expression read from the class's static constants, so templated
+ * simulation code compiles to literals with no virtual calls. Code instantiated
+ * for CustomProtocol goes through ProtocolTraits<CustomProtocol>, which reads
+ * the runtime parameters instead.
+ */
+template <class P>
+struct ProtocolTraits {
+    static constexpr bool COMPILE_TIME = true;
+    static constexpr bool VOICE_CENTRIC = P::VOICE_CENTRIC;
+
+    static constexpr int usersPerChannel(const P&) { return P::USERS_PER_CHANNEL; }
+    static constexpr int maxUsers(const P&) { return P::MAX_USERS; }
+    static constexpr int messagesPerUser(const P&) { return P::MESSAGES_PER_USER; }
+    static constexpr int requiredCores(const P&) { return P::REQUIRED_CORES; }
+    static constexpr int bandOffsetKhz(const P&) { return P::BAND_OFFSET_KHZ; }
+    static constexpr int frequency(const P&, int index) {
+        return (index < 0 || index >= P::CHANNEL_COUNT) ? -1 : index * P::CHANNEL_BANDWIDTH_KHZ;
+    }
+};
+
+template <>
+struct ProtocolTraits<CustomProtocol> {
+    static constexpr bool COMPILE_TIME = false;
+    static constexpr bool VOICE_CENTRIC = false;
+
+    static int usersPerChannel(const CustomProtocol& p) { return p.getUsersPerChannel(); }
+    static int maxUsers(const CustomProtocol& p) { return p.calculateMaxUsers(); }
+    static int messagesPerUser(const CustomProtocol& p) { return p.getMessagesPerUser(); }
+    static int requiredCores(const CustomProtocol& p) { return p.calculateRequiredCores(); }
+    static int bandOffsetKhz(const CustomProtocol&) { return 0; }
+    static int frequency(const CustomProtocol& p, int index) { return p.getFrequencyChannel(index); }
+};
+
+#endif // PROTOCOL_TRAITS_H
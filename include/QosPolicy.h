@@ -0,0 +1,36 @@
+/* QosPolicy.h
+ * Voice/data scheduling discipline used by a tower's waiting queues.
+ * C++17
+ */
+#ifndef QOS_POLICY_H
+#define QOS_POLICY_H
+
+/**
+ * @enum QueueDiscipline
+ * @brief Which waiting message a tower serves when a channel frees up.
+ */
+enum class QueueDiscipline : unsigned char {
+    FIFO,            ///< Oldest message first, regardless of class
+    STRICT_PRIORITY, ///< Voice whenever any voice is waiting
+    WEIGHTED_FAIR    ///< Voice and data share service in voiceWeight : dataWeight
+};
+
+/**
+ * @brief A discipline plus its class weights (weights only matter for WEIGHTED_FAIR).
+ */
+struct QosPolicy {
+    QueueDiscipline discipline = QueueDiscipline::FIFO;
+    int voiceWeight = 1;
+    int dataWeight = 1;
+};
+
+/// Short lowercase name ("fifo", "priority", "wfq") for reports and batch options.
+inline const char* disciplineName(QueueDiscipline discipline) {
+    switch (discipline) {
+    case QueueDiscipline::STRICT_PRIORITY: return "priority";
+    case QueueDiscipline::WEIGHTED_FAIR: return "wfq";
+    default: return "fifo";
+    }
+}
+
+#endif // QOS_POLICY_H
@@ -0,0 +1,95 @@
+/* ResultWriter.h
+ * Streams machine-readable result records as key=value text, CSV or JSON lines.
+ * C++17
+ */
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+/**
+ * @enum ResultFormat
+ * @brief Layout of the records written by ResultWriter.
+ */
+enum class ResultFormat : unsigned char {
+    KEY_VALUE,  ///< "result run=1 status=ok ..." (the batch mode's default)
+    CSV,        ///< Header from the first table record, then one row per record
+    JSON_LINES  ///< One JSON object per line, with a "record" member naming its kind
+};
+
+/// "text", "csv" or "jsonl".
+inline const char* formatName(ResultFormat format) {
+    switch (format) {
+    case ResultFormat::CSV: return "csv";
+    case ResultFormat::JSON_LINES: return "jsonl";
+    default: return "text";
+    }
+}
+
+/**
+ * @brief Buffered writer for flat result records.
+ *
+ * A record is built field by field (beginRecord, field..., endRecord) in a
+ * line buffer and then appended to a 64 KB output buffer that is written to
+ * the file descriptor whenever it fills, so arbitrarily many records stream
+ * out in constant memory. Writing to stdout flushes basicIO first, keeping the
+ * records in order with anything printed through io.
+ *
+ * In CSV the first record's kind and keys become the table and its header;
+ * records of any other kind (e.g. the closing summary) go to stderr as
+ * key=value text so the table stays clean. Later table records must use the
+ * same keys in the same order. Strings are quoted and escaped as each format
+ * requires.
+ */
+class ResultWriter {
+public:
+    static constexpr int BUFFER_SIZE = 1 << 16;
+    static constexpr int LINE_SIZE = 8192;
+
+private:
+    ResultFormat format_;
+    int fd_;                  ///< 1 = stdout
+    bool ownsFd_;
+    char buffer_[BUFFER_SIZE];
+    int length_;
+
+    char line_[LINE_SIZE];    ///< record being built
+    int lineLength_;
+    char header_[LINE_SIZE];  ///< CSV header, built from the first table record
+    int headerLength_;
+    char table_[32];          ///< CSV: kind of the table records
+    bool headerDone_;
+    bool tableRecord_;        ///< CSV: the current record belongs to the table
+    int fields_;              ///< fields in the current record
+
+    void put(char* target, int& length, const char* text, int size);
+    void put(char* target, int& length, const char* text);
+    void putQuoted(char* target, int& length, const char* text);
+    void beginField(const char* key);
+    void append(const char* data, int size);
+
+public:
+    explicit ResultWriter(ResultFormat format);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    /**
+     * @brief Sends records to path (created or truncated) instead of stdout.
+     * @return false if the file cannot be opened
+     */
+    bool open(const char* path);
+
+    void beginRecord(const char* kind);
+    void field(const char* key, long long value);
+    void field(const char* key, int value) { field(key, static_cast<long long>(value)); }
+    void field(const char* key, const char* value);
+    void field(const char* key, double value);   ///< Written with two decimals
+    void endRecord();
+
+    /// Writes out buffered records.
+    void flush();
+
+    ResultFormat getFormat() const { return format_; }
+};
+
+#endif // RESULT_WRITER_H
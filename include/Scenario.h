@@ -0,0 +1,138 @@
+/* Scenario.h
+ * Non-interactive batch mode: options from the command line or a scenario file.
+ * C++17
+ */
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "ResultWriter.h"
+#include "Simulation.h"
+
+/**
+ * @brief A batch scenario: one simulation configuration repeated N times.
+ *
+ * Options use the same keys on the command line (--key=value or --key value)
+ * and in scenario files (key=value per line, '#' starts a comment):
+ *
+ *   protocol           2g | 3g | 4g | 5g | custom (or menu number 1-5)
+ *   users-per-channel  custom protocol only
+ *   channel-bandwidth  custom protocol only (kHz)
+ *   total-spectrum     custom protocol only (kHz)
+ *   messages           total messages per run
+ *   overhead           overhead percentage (0-100)
+ *   devices            synthetic | path to a CSV device inventory
+ *   save-snapshot      save the device population to a binary snapshot file
+ *   load-snapshot      restore the device population from a snapshot file instead
+ *                      of attaching devices (same protocol and overhead)
+ *   repeat             number of runs (default 1)
+ *   threads            processing threads (default 0 = automatic)
+ *   duration-ms        simulated time; > 0 runs the event-driven queueing model
+ *   arrival-rate       event-driven: messages per second per device (default 1)
+ *   service-rate       event-driven: messages per second per channel
+ *                      (default 0 = users-per-channel x messages-per-user)
+ *   queue-limit        event-driven: waiting messages per class per tower (default 0 = tower capacity)
+ *   voice-rate         event-driven: voice messages per second per device (overrides
+ *                      the voice share of arrival-rate)
+ *   data-rate          event-driven: data messages per second per device (likewise)
+ *   scheduler          event-driven: protocol | fifo | priority | wfq (default protocol)
+ *   voice-weight       event-driven: weighted-fair voice weight (default: protocol's)
+ *   data-weight        event-driven: weighted-fair data weight (default: protocol's)
+ *   towers             > 0 runs the multi-tower mobility/handover model instead of traffic
+ *   mobile-devices     topology: moving devices (default 20 per tower)
+ *   layout             topology: grid | random (default grid)
+ *   spacing            topology: inter-site distance in metres (default 1000)
+ *   min-speed          topology: slowest device in m/s (default 1)
+ *   max-speed          topology: fastest device in m/s (default 30)
+ *   step-ms            topology: mobility time step (default 100); duration-ms sets the
+ *                      simulated time (default 60000)
+ *   hysteresis         topology: metres a tower must beat the serving one by (default 50)
+ *   tower-capacity     topology: devices per tower (default 0 = protocol maximum less overhead)
+ *   tower-index        topology: grid (spatial index, default) | scan (check every tower)
+ *   format             text (key=value, default) | csv | jsonl
+ *   output             write result records to this file instead of stdout
+ *   scenario           read further options from a file (command line only)
+ *
+ * Sweep options turn the scenario into a grid of runs, one per combination of
+ * values (see SweepOptions):
+ *
+ *   sweep-protocols          list of protocols, e.g. 2g,3g,4g,5g,custom
+ *   sweep-overhead           values for overhead
+ *   sweep-messages           values for messages
+ *   sweep-users-per-channel  values for users-per-channel (custom only)
+ *   sweep-channel-bandwidth  values for channel-bandwidth (custom only)
+ *   sweep-total-spectrum     values for total-spectrum (custom only)
+ *   jobs                     concurrent runs (default 0 = hardware threads)
+ *
+ * Values are comma-separated items, each a number or first:last[:step],
+ * e.g. "0:50:10" or "5,10,20:40:10".
+ */
+
+/**
+ * @brief The values one swept parameter takes.
+ */
+struct SweepAxis {
+    static constexpr int MAX_VALUES = 1024;
+
+    long long values[MAX_VALUES];
+    int count = 0;                   ///< 0 = not swept (the scenario's value is used)
+};
+
+/**
+ * @brief Parameter ranges of a sweep; empty axes keep the scenario's value.
+ */
+struct SweepOptions {
+    bool enabled = false;            ///< Set by any sweep-* option
+    int protocols[5] = {0};          ///< protocolChoice values to run
+    int protocolCount = 0;           ///< 0 = the scenario's protocol
+    SweepAxis overhead;
+    SweepAxis messages;
+    SweepAxis usersPerChannel;       ///< Custom protocol only
+    SweepAxis channelBandwidth;      ///< Custom protocol only
+    SweepAxis totalSpectrum;         ///< Custom protocol only
+    int jobs = 0;                    ///< Concurrent runs; 0 = hardware threads
+};
+
+struct ScenarioOptions {
+    static constexpr int MAX_PATH = 256;
+
+    SimulationConfig config;
+    int repetitions = 1;
+    char deviceFile[MAX_PATH] = {0};
+    ResultFormat format = ResultFormat::KEY_VALUE;
+    char outputFile[MAX_PATH] = {0};  ///< empty = stdout
+    char snapshotLoad[MAX_PATH] = {0};
+    char snapshotSave[MAX_PATH] = {0};
+    SweepOptions sweep;
+};
+
+/// Applies one key/value option; prints the problem to stderr and returns false if invalid.
+bool applyScenarioOption(const char* key, const char* value, ScenarioOptions& options);
+
+/// Reads key=value lines from path into options.
+bool loadScenarioFile(const char* path, ScenarioOptions& options);
+
+/// Parses argv (excluding argv[0]); returns false on any invalid option.
+bool parseScenarioArguments(int argc, char** argv, ScenarioOptions& options);
+
+/**
+ * @brief Runs the scenario without prompts and writes one machine-readable
+ * "result" record per run followed by a "summary" record, in options.format,
+ * through a ResultWriter. Sweeps are handed to runSweep().
+ * @return Process exit code: 0 if every run succeeded, 1 otherwise
+ */
+int runScenario(const ScenarioOptions& options);
+
+/**
+ * @brief Runs every point of options.sweep (times options.repetitions) on a
+ * thread pool and writes one "result" record per run, in point order, followed
+ * by a "summary" record. Runs are executed and written a chunk at a time, so
+ * memory does not grow with the number of points.
+ *
+ * Each run is an independent runSimulation() with its own network, cores and
+ * towers, so points share nothing and throughput scales with jobs. Runs use one
+ * processing thread each unless the scenario sets threads.
+ * @return Process exit code: 0 if every run succeeded, 1 otherwise
+ */
+int runSweep(const ScenarioOptions& options);
+
+#endif // SCENARIO_H
@@ -0,0 +1,86 @@
+/* Simulation.h
+ * One end-to-end simulation run, shared by the interactive menu and batch mode.
+ * C++17
+ */
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "CellularNetwork.h"
+#include "CommunicationProtocol.h"
+#include "EventSimulator.h"
+#include "Topology.h"
+
+/**
+ * @brief Inputs for one simulation run (the answers to the interactive prompts).
+ */
+struct SimulationConfig {
+    int protocolChoice = 0;          ///< Menu numbering: 1 = 2G, 2 = 3G, 3 = 4G, 4 = 5G, 5 = Custom
+    int usersPerChannel = 0;         ///< Custom protocol only
+    int channelBandwidth = 0;        ///< Custom protocol only (kHz)
+    int totalSpectrum = 0;           ///< Custom protocol only (kHz)
+    long long totalMessages = 0;
+    int overheadPercent = 0;         ///< Clamped to [0, 100]
+    const char* deviceFile = nullptr; ///< CSV device inventory; nullptr = synthetic devices
+    int threads = 0;                 ///< Threads for core processing; 0 = automatic
+    int balancing = 0;               ///< BalancingPolicy value spreading devices over the cores
+    long long durationMs = 0;        ///< > 0 switches to the event-driven model for this simulated time
+    double arrivalRate = 1.0;        ///< Event-driven: messages per second per device
+    double serviceRate = 0.0;        ///< Event-driven: messages per second per channel; 0 = protocol-derived
+    int queueLimit = 0;              ///< Event-driven: waiting messages per class per tower; 0 = tower capacity
+    double voiceRate = -1.0;         ///< Event-driven: voice messages per second per device; < 0 = arrival-rate share
+    double dataRate = -1.0;          ///< Event-driven: data messages per second per device; < 0 = arrival-rate share
+    int qosDiscipline = -1;          ///< Event-driven: QueueDiscipline value; -1 = the protocol's
+    int voiceWeight = 0;             ///< Event-driven: weighted-fair voice weight; 0 = the protocol's
+    int dataWeight = 0;              ///< Event-driven: weighted-fair data weight; 0 = the protocol's
+    int mixVoice = 0;                ///< Voice:data message mix (e.g. 1:3); 0:0 = the protocol's
+    int mixData = 0;
+    TopologyConfig topology;         ///< topology.towerCount > 0 runs the mobility/handover model instead
+    const char* snapshotLoad = nullptr; ///< Restore the device population from this Snapshot file
+    const char* snapshotSave = nullptr; ///< Save the device population to this Snapshot file
+};
+
+/**
+ * @brief Outcome of one simulation run.
+ */
+struct SimulationResult {
+    const char* protocolName = "";
+    int coreCount = 0;
+    BalancingPolicy balancing = BalancingPolicy::ROUND_ROBIN;
+    int maxDevices = 0;              ///< Device budget after overhead reduction
+    int devicesAdded = 0;
+    bool devicesFromFile = false;
+    bool devicesFromSnapshot = false;
+    long long populateNs = 0;        ///< Wall time attaching (or restoring) devices
+    long long totalMessages = 0;
+    long long voiceMessages = 0;
+    long long dataMessages = 0;
+    long long overheadMessages = 0;
+    long long processed = 0;
+    long long failed = 0;
+    int firstChannelFreq = 0;        ///< kHz, as displayed (5G offset by 1800 MHz)
+    int firstChannelUsers = 0;
+    int maxChannelUsers = 0;
+    ChannelStats channels;           ///< Occupancy of every channel after devices are attached
+    long long elapsedNs = 0;         ///< Device population plus traffic
+    bool eventDriven = false;        ///< events holds the queueing results
+    EventStats events;
+    QosPolicy qos;                   ///< Scheduling used by the event-driven run
+    bool topologyMode = false;       ///< handover holds the mobility results
+    int towerCount = 0;
+    HandoverStats handover;
+};
+
+/// Creates the protocol selected by config, or nullptr if the choice/parameters are invalid.
+CommunicationProtocol* createProtocol(const SimulationConfig& config);
+
+/// Prints the "Protocol Information" block shown after a protocol is selected.
+void printProtocolInfo(const CommunicationProtocol* protocol, int protocolChoice);
+
+/**
+ * @brief Runs overhead calculation, device allocation and message processing.
+ * @param verbose Print the human-readable progress report while running
+ * @return false if the configuration could not be simulated
+ */
+bool runSimulation(const SimulationConfig& config, SimulationResult& result, bool verbose);
+
+#endif // SIMULATION_H
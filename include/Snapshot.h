@@ -0,0 +1,52 @@
+/* Snapshot.h
+ * Versioned binary snapshots of CellularCore state for fast warm starts.
+ * C++17
+ */
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "CellularCore.h"
+
+/**
+ * @brief Saves and restores the contents of a group of CellularCores.
+ *
+ * A snapshot holds, per core, the lifetime counters, the interned payloads, the
+ * queued messages and, per tower, the device columns (ids, channel indices,
+ * connection types, connected flags) plus the allocation policy. Every section
+ * starts on an 8-byte boundary and the columns are stored exactly as DeviceTable
+ * keeps them, so load() maps the file and copies each column in one pass; the
+ * only fix-up is recounting channel loads and re-indexing device ids, which
+ * replaces one allocateFrequency-style search per device.
+ *
+ * Layout (native byte order, checked on load):
+ *
+ *   Header       magic "CELLSNAP", version, byte-order mark, core count, file size
+ *   per core     CoreRecord, payload texts (ids 1..n-1, NUL-terminated),
+ *                queued Messages (16 bytes each, oldest first)
+ *   per tower    TowerRecord, ids[n], channels[n], types[n], connected[n]
+ *
+ * Snapshots describe contents, not structure: the cores passed to load() must
+ * already hold towers with the saved ids, protocols and capacities (e.g. a
+ * CellularNetwork built from the same configuration) with no devices or
+ * queued messages. A mismatch, a bad version or a truncated file makes load()
+ * fail; cores restored before the failure keep their new contents.
+ */
+class Snapshot {
+public:
+    static constexpr unsigned int VERSION = 1;
+
+    /**
+     * @brief Writes coreCount cores to path (created or truncated).
+     * @return false if the file cannot be written
+     */
+    static bool save(const char* path, const CellularCore* const* cores, int coreCount);
+
+    /**
+     * @brief Restores coreCount cores from path.
+     * @return false if the file is missing, malformed, of another version or
+     *         does not match the cores
+     */
+    static bool load(const char* path, CellularCore* const* cores, int coreCount);
+};
+
+#endif // SNAPSHOT_H
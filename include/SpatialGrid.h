@@ -0,0 +1,67 @@
+/* SpatialGrid.h
+ * Uniform-grid index over tower positions for nearest-tower queries.
+ * C++17
+ */
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+/**
+ * @brief Buckets points into square cells so a nearest-point query only looks
+ *        at the cells around the query instead of every point.
+ *
+ * Cells are sized for about two points each over the indexed region. The
+ * points of all cells are stored back to back (grouped by a counting sort) with
+ * one start offset per cell, together with copies of their coordinates.
+ * nearest() searches rings of cells outwards from the query's cell and stops
+ * once the next ring cannot hold anything closer, so a query over evenly spread
+ * points costs O(1) regardless of how many there are.
+ *
+ * Results match a linear scan exactly, including ties (lowest index wins).
+ */
+class SpatialGrid {
+private:
+    int count_;
+    double minX_;
+    double minY_;
+    double cellSize_;
+    double inverseCellSize_;
+    int columns_;
+    int rows_;
+    int* cellStart_;        // columns_ * rows_ + 1 offsets into cellPoints_
+    int* cellPoints_;       // point indices grouped by cell
+    double* cellX_;         // coordinates in the same order, so a cell is one contiguous run
+    double* cellY_;
+
+    int clampColumn(double x) const;
+    int clampRow(double y) const;
+    void scanCell(int column, int row, double x, double y, int& best, double& bestDistance2) const;
+
+public:
+    SpatialGrid();
+    ~SpatialGrid();
+
+    SpatialGrid(const SpatialGrid&) = delete;
+    SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+    /**
+     * @brief Indexes count points (coordinates are copied; rebuild after moving points).
+     *
+     * The region is grown to cover every point, so queries anywhere are valid;
+     * those outside the region just search more rings.
+     */
+    void build(const double* xs, const double* ys, int count,
+               double minX, double minY, double maxX, double maxY);
+
+    /// Index of the point nearest to (x, y), or -1 if the grid is empty.
+    int nearest(double x, double y, double& distance2) const;
+
+    /// Linear scan with the same tie-breaking, for comparison and testing.
+    static int nearestByScan(const double* xs, const double* ys, int count,
+                             double x, double y, double& distance2);
+
+    int getColumns() const { return columns_; }
+    int getRows() const { return rows_; }
+    long long getMemoryUsage() const;
+};
+
+#endif // SPATIAL_GRID_H
@@ -0,0 +1,58 @@
+/* ThreadPool.h
+ * Fixed-size pool of worker threads for data-parallel loops.
+ * C++17
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Runs indexed tasks across a fixed set of threads (parallel-for).
+ *
+ * The calling thread participates, so a pool of N threads starts N - 1 workers.
+ * run() blocks until every task has finished; tasks are claimed dynamically.
+ */
+class ThreadPool {
+public:
+    typedef void (*TaskFunction)(int taskIndex, void* context);
+
+private:
+    int threadCount_;
+    std::thread* workers_;
+
+    std::mutex mutex_;
+    std::condition_variable startCv_;
+    std::condition_variable doneCv_;
+    long long generation_;
+    bool stopping_;
+    int busyWorkers_;
+
+    TaskFunction task_;
+    void* context_;
+    int taskCount_;
+    std::atomic<int> nextTask_;
+
+    void workerLoop();
+    void drainTasks();
+
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return threadCount_; }
+
+    /// Calls task(i, context) for i in [0, taskCount) and waits for all of them.
+    void run(int taskCount, TaskFunction task, void* context);
+
+    /// Number of hardware threads, at least 1.
+    static int hardwareThreads();
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,140 @@
+/* Topology.h
+ * Many towers on a plane with mobile devices that hand over between them.
+ * C++17
+ */
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include "CellTower.h"
+#include "CommunicationProtocol.h"
+#include "SpatialGrid.h"
+
+/**
+ * @enum TowerLayout
+ * @brief How tower sites are placed over the coverage area.
+ */
+enum class TowerLayout : unsigned char {
+    GRID,   ///< Square grid with spacingM between neighbours
+    RANDOM  ///< Uniformly random over the same area as the grid
+};
+
+/**
+ * @brief Parameters of a mobility run.
+ */
+struct TopologyConfig {
+    int towerCount = 0;            ///< > 0 selects topology mode
+    int deviceCount = 0;           ///< Mobile devices; 0 = 20 per tower
+    TowerLayout layout = TowerLayout::GRID;
+    double spacingM = 1000.0;      ///< Inter-site distance; the area is sqrt(towers) sites wide
+    double minSpeed = 1.0;         ///< Device speed range in m/s
+    double maxSpeed = 30.0;
+    long long stepMs = 100;        ///< Mobility time step
+    long long durationMs = 60000;  ///< Simulated time
+    double hysteresisM = 50.0;     ///< A candidate must be this much closer than the serving tower
+    int towerCapacity = 0;         ///< Devices per tower; 0 = the protocol's maximum
+    bool spatialIndex = true;      ///< Find nearest towers through a SpatialGrid; false = scan all towers
+    unsigned long long seed = 1;
+};
+
+/**
+ * @brief Handover counters and phase timings of a mobility run.
+ */
+struct HandoverStats {
+    long long steps = 0;
+    long long attempts = 0;          ///< Handovers tried (a closer tower was found)
+    long long handovers = 0;         ///< Completed handovers
+    long long capacityFailures = 0;  ///< Target tower had no free slot or channel
+    long long attachFailures = 0;    ///< Attach attempts refused by a full nearest tower (an unattached device retries every step)
+    int attached = 0;                ///< Devices attached at the end
+    int unattached = 0;              ///< Devices without a tower at the end
+    long long simulatedNs = 0;
+    long long mobilityNs = 0;        ///< Wall time moving devices
+    long long selectionNs = 0;       ///< Wall time finding each device's best tower
+    long long handoverNs = 0;        ///< Wall time detaching/attaching devices
+    long long wallNs = 0;            ///< Whole run(), including the above
+};
+
+/**
+ * @brief A multi-tower network with random-waypoint mobility.
+ *
+ * Every tower is an independent CellTower (there is no MAX_TOWERS limit here).
+ * Devices move towards random waypoints at random speeds; after each step a
+ * device whose nearest tower beats its serving tower by more than hysteresisM
+ * is handed over make-before-break: it is attached to the target first and
+ * only detached from the old tower if that succeeds, so a full target leaves
+ * the device where it was and counts a capacity failure. Devices that could
+ * not attach anywhere retry their nearest tower every step.
+ *
+ * Device state is kept in parallel arrays and the handovers of a step are
+ * collected before any is executed, so each phase is one tight loop. Nearest
+ * towers come from a SpatialGrid over the tower sites (O(1) per device) unless
+ * spatialIndex is off, in which case every tower is scanned.
+ */
+class Topology {
+private:
+    const CommunicationProtocol* protocol_;
+    TopologyConfig config_;
+
+    int towerCount_;
+    CellTower** towers_;
+    double* towerX_;
+    double* towerY_;
+    double width_;
+    double height_;
+    SpatialGrid towerGrid_;
+
+    int deviceCount_;
+    int* deviceIds_;
+    ConnectionType* deviceTypes_;
+    double* x_;
+    double* y_;
+    double* destX_;
+    double* destY_;
+    double* speed_;
+    int* serving_;          ///< tower index, or -1 when unattached
+
+    int* pendingDevice_;    ///< handovers found by the current step
+    int* pendingTower_;
+    int pendingCount_;
+
+    HandoverStats stats_;
+    unsigned long long rng_;
+
+    double nextUniform();
+    void pickWaypoint(int device);
+    int nearestTower(double x, double y, double& distance2) const;
+    void move(double seconds);
+    void select();
+    void executeHandovers();
+
+public:
+    /**
+     * @param protocol Shared by every tower (not owned)
+     * @param firstDeviceId Devices get ids firstDeviceId, firstDeviceId + 1, ...
+     */
+    Topology(const CommunicationProtocol* protocol, const TopologyConfig& config, int firstDeviceId);
+    ~Topology();
+
+    Topology(const Topology&) = delete;
+    Topology& operator=(const Topology&) = delete;
+
+    /// Attaches every device to its nearest tower (call once, before run()).
+    void attachAll();
+
+    /// Steps mobility and handovers until config.durationMs.
+    void run();
+
+    int getTowerCount() const { return towerCount_; }
+    int getDeviceCount() const { return deviceCount_; }
+    CellTower* getTower(int index) const { return towers_[index]; }
+    int getServingTower(int device) const { return serving_[device]; }
+    const HandoverStats& getStats() const { return stats_; }
+
+    /// Bytes owned by the topology, its towers and the device arrays.
+    long long getMemoryUsage() const;
+
+    /// Prints the human-readable handover report.
+    void printReport() const;
+};
+
+#endif // TOPOLOGY_H
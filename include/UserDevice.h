@@ -9,50 +9,45 @@
  * @enum ConnectionType
  * @brief Type of connection for a user device.
  */
-enum class ConnectionType {
+enum class ConnectionType : unsigned char {
     DATA,  ///< Data connection (packet switching)
     VOICE  ///< Voice connection (circuit switching)
 };
 
+class DeviceTable;
+class CellTower;
+
 /**
- * @brief Represents a single user device connected to the cellular network.
+ * @brief Handle to one device attached to a CellTower.
  *
- * Each device has a unique ID, assigned frequency, and connection type.
- * Data hiding ensures validation of all member access through public interface.
+ * The device's fields live in the tower's DeviceTable; a UserDevice only records
+ * which row they are in. Handles are created and kept up to date by the tower
+ * (rows move when other devices detach) and become invalid once the device is
+ * removed from its tower.
  */
 class UserDevice {
 private:
-    int deviceId_;                  ///< Unique identifier for this device
-    int assignedFrequency_;         ///< Assigned frequency in kHz
-    ConnectionType connectionType_; ///< Type of connection (DATA or VOICE)
-    bool isConnected_;              ///< Connection status
+    DeviceTable* table_; ///< Owning tower's device table
+    int row_;            ///< Current row in table_
 
-    /**
-     * @brief Validate device ID and frequency values.
-     * @throw Throws if validation fails (called from constructor/setters)
-     */
-    void validate() const;
+    friend class CellTower;
+    void setRow(int row) { row_ = row; }
 
 public:
-    UserDevice(int deviceId, int frequency, ConnectionType type);
+    UserDevice(DeviceTable* table, int row) : table_(table), row_(row) {}
     ~UserDevice() = default;
 
     // Prevent copying
     UserDevice(const UserDevice&) = delete;
     UserDevice& operator=(const UserDevice&) = delete;
 
-    // Allow move semantics
-    UserDevice(UserDevice&&) = default;
-    UserDevice& operator=(UserDevice&&) = default;
-
-    int getDeviceId() const { return deviceId_; }
-    int getAssignedFrequency() const { return assignedFrequency_; }
-    ConnectionType getConnectionType() const { return connectionType_; }
-    bool isConnected() const { return isConnected_; }
+    int getDeviceId() const;
+    int getAssignedFrequency() const;
+    ConnectionType getConnectionType() const;
+    bool isConnected() const;
 
-    void setAssignedFrequency(int frequency);
-    void setConnectionType(ConnectionType type) { connectionType_ = type; }
-    void setConnected(bool connected) { isConnected_ = connected; }
+    void setConnectionType(ConnectionType type);
+    void setConnected(bool connected);
 };
 
 #endif // USER_DEVICE_H
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef BASIC_IO_H
+#define BASIC_IO_H
+
+/**
+ * @brief Minimal syscall-backed I/O wrapper.
+ *
+ * Standard output is buffered in user space: the buffer is written out when it
+ * fills, when flush() is called, before any input is read, and on every newline
+ * while stdout is an interactive terminal. Standard error is unbuffered and does
+ * not flush stdout, so the error functions are safe from any thread; call flush()
+ * first where a message must follow pending stdout text.
+ */
+class basicIO {
+public:
+    static constexpr int OUTPUT_BUFFER_SIZE = 1 << 16;
+
+private:
+    char outputBuffer_[OUTPUT_BUFFER_SIZE];
+    int outputLength_;
+    int interactive_; ///< -1 = not yet probed, 0 = pipe/file, 1 = terminal
+    bool inputClosed_;
+
+    bool isInteractive();
+    void append(const char* data, long len);
+
+public:
+    basicIO();
+    ~basicIO();
+
+    basicIO(const basicIO&) = delete;
+    basicIO& operator=(const basicIO&) = delete;
+
+    void activateInput();
+    int inputint();
+    bool inputClosed() const { return inputClosed_; }
+    const char* inputstring();
+    void inputstring(char* buffer, int size);
+    void outputint(int value);
+    void outputlong(long long value);
+    void outputstring(const char* text);
+    void terminate();
+    void flush();
+    void errorstring(const char* text);
+    void errorint(int number);
+    void errorlong(long long number);
+
+};
+
+extern basicIO io;
+
+
+#endif
@@ -5,106 +5,314 @@
 #include "../include/CellTower.h"
 #include "../include/basicIO.h"
 
-CellTower::CellTower(int towerId, const CommunicationProtocol* protocol)
-    : towerId_(towerId), protocol_(protocol), deviceCount_(0) {
+#include <cmath> // for std::sqrt
+
+static int channelCountOf(const CommunicationProtocol* protocol) {
+    int count = protocol ? protocol->getChannelCount() : 0;
+    return count > 0 ? count : 0;
+}
+
+static int towerCapacity(const CommunicationProtocol* protocol, int maxDevices) {
+    if (!protocol) return 0;
+    int maxUsers = protocol->calculateMaxUsers();
+    if (maxUsers < 0) return 0;
+    if (maxDevices > CellTower::MAX_DEVICES) maxDevices = CellTower::MAX_DEVICES;
+    if (maxDevices < 0) maxDevices = 0;
+    return maxUsers < maxDevices ? maxUsers : maxDevices;
+}
+
+CellTower::CellTower(int towerId, const CommunicationProtocol* protocol, int maxDevices)
+    : towerId_(towerId), protocol_(protocol), capacity_(towerCapacity(protocol, maxDevices)),
+      channelFrequency_(new int[channelCountOf(protocol) > 0 ? channelCountOf(protocol) : 1]),
+      table_(capacity_, channelFrequency_, channelCountOf(protocol)),
+      devices_(new UserDevice*[capacity_ > 0 ? capacity_ : 1]),
+      devicePool_(capacity_ > 0 && capacity_ < DevicePool::DEFAULT_SLAB_SLOTS
+                      ? capacity_ : DevicePool::DEFAULT_SLAB_SLOTS),
+      deviceIndex_(capacity_),
+      channels_(channelCountOf(protocol), protocol ? protocol->getUsersPerChannel() : 0),
+      policy_(AllocationPolicy::FIRST_FIT) {
+    int channelCount = channels_.getChannelCount();
+
     if (!protocol_) {
         io.outputstring("Error: Protocol cannot be null");
         io.terminate();
         return;
     }
-    for (int i = 0; i <= MAX_FREQ_KHZ; ++i) {
-        frequencyAllocation_[i] = 0;
-    }
-    for (int i = 0; i < MAX_DEVICES; ++i) {
-        devices_[i] = nullptr;
+
+    for (int i = 0; i < channelCount; ++i) {
+        int freq = protocol_->getFrequencyChannel(i);
+        channelFrequency_[i] = freq;
+        if (freq < 0) {
+            channels_.excludeChannel(i);
+        }
     }
 }
 
 CellTower::~CellTower() {
-    for (int i = 0; i < deviceCount_; ++i) {
-        if (devices_[i]) {
-            delete devices_[i];
-            devices_[i] = nullptr;
+    delete[] devices_; // devices themselves go with devicePool_
+    delete[] channelFrequency_;
+}
+
+long long CellTower::getMemoryUsage() const {
+    return static_cast<long long>(sizeof(*this))
+         + static_cast<long long>(capacity_) * sizeof(UserDevice*)
+         + static_cast<long long>(channels_.getChannelCount()) * sizeof(int)
+         + table_.getMemoryUsage()
+         + devicePool_.getMemoryUsage()
+         + channels_.getMemoryUsage()
+         + deviceIndex_.getMemoryUsage();
+}
+
+int CellTower::channelIndexOf(int frequency) const {
+    int lo = 0;
+    int hi = channels_.getChannelCount() - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (channelFrequency_[mid] == frequency) return mid;
+        if (channelFrequency_[mid] < frequency) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
         }
     }
+    return -1;
 }
 
-bool CellTower::isFrequencyAtCapacity(int frequency) const {
-    if (frequency < 0 || frequency > MAX_FREQ_KHZ) return true;
-    int usersOnFreq = frequencyAllocation_[frequency];
-    int capacity = protocol_->getUsersPerChannel();
-    return usersOnFreq >= capacity;
+int CellTower::getUsersOnFrequency(int frequency) const {
+    int channel = channelIndexOf(frequency);
+    return channel >= 0 ? channels_.getLoad(channel) : 0;
 }
 
-int CellTower::getUsersOnFrequency(int frequency) const {
-    if (frequency < 0 || frequency > MAX_FREQ_KHZ) return 0;
-    return frequencyAllocation_[frequency];
+double LoadSummary::stddev() const {
+    if (channels == 0) return 0.0;
+    double m = mean();
+    double variance = static_cast<double>(sumSquares) / channels - m * m;
+    return variance > 0 ? std::sqrt(variance) : 0.0;
 }
 
-UserDevice* CellTower::getDevice(int index) const {
-    if (index < 0 || index >= deviceCount_) return nullptr;
-    return devices_[index];
+void LoadSummary::merge(const LoadSummary& other) {
+    if (other.channels == 0) return;
+    if (channels == 0 || other.min < min) min = other.min;
+    if (channels == 0 || other.max > max) max = other.max;
+    channels += other.channels;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
 }
 
-bool CellTower::allocateFrequency(UserDevice* device) {
-    if (!device) {
-        io.outputstring("Error: Device cannot be null");
-        io.terminate();
-        return false;
+void ChannelStats::merge(const ChannelStats& other) {
+    if (other.total.channels == 0) return;
+    if (total.channels == 0 || other.total.max > total.max) {
+        busiestTowerId = other.busiestTowerId;
+        busiestChannel = other.busiestChannel;
     }
+    if (other.capacity > capacity) capacity = other.capacity;
+    total.merge(other.total);
+    voice.merge(other.voice);
+    data.merge(other.data);
+    emptyChannels += other.emptyChannels;
+    fullChannels += other.fullChannels;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) histogram[b] += other.histogram[b];
+}
 
-    int channelCount = protocol_->getChannelCount();
-    
-    for (int i = 0; i < channelCount; ++i) {
-        int freq = protocol_->getFrequencyChannel(i);
-        if (freq >= 0 && freq <= MAX_FREQ_KHZ && !isFrequencyAtCapacity(freq)) {
-            device->setAssignedFrequency(freq);
-            frequencyAllocation_[freq]++;
-            return true;
+// Running totals of one getChannelStats() pass.
+struct LoadTotals {
+    int counted = 0, empty = 0, full = 0;
+    int totalMin, totalMax = 0, voiceMin, voiceMax = 0, dataMin, dataMax = 0;
+    long long totalSum = 0, voiceSum = 0, dataSum = 0;
+    long long totalSquares = 0, voiceSquares = 0, dataSquares = 0;
+};
+
+// Accumulates channels [begin, end) without branches: unusable channels are
+// masked arithmetically (u = 0 zeroes their sums, and the minimums see them at
+// capacity), so the loop vectorizes. Square is the accumulator type of the
+// sums of squares; 32-bit lanes vectorize, 64-bit ones do not on x86-64.
+template <class Square>
+static void accumulateLoads(const int* load, const int* voiceLoad, const unsigned char* usable,
+                            int begin, int end, int capacity, LoadTotals& totals) {
+    int counted = 0, empty = 0, full = 0, totalSum = 0, voiceSum = 0, dataSum = 0;
+    int totalMin = totals.totalMin, voiceMin = totals.voiceMin, dataMin = totals.dataMin;
+    int totalMax = totals.totalMax, voiceMax = totals.voiceMax, dataMax = totals.dataMax;
+    Square totalSquares = 0, voiceSquares = 0, dataSquares = 0;
+    for (int c = begin; c < end; ++c) {
+        int u = usable[c];
+        int t = load[c] * u;
+        int v = voiceLoad[c] * u;
+        int d = t - v;
+        int gap = capacity * (1 - u);
+        counted += u;
+        totalMin = t + gap < totalMin ? t + gap : totalMin;
+        voiceMin = v + gap < voiceMin ? v + gap : voiceMin;
+        dataMin = d + gap < dataMin ? d + gap : dataMin;
+        totalMax = t > totalMax ? t : totalMax;
+        voiceMax = v > voiceMax ? v : voiceMax;
+        dataMax = d > dataMax ? d : dataMax;
+        totalSum += t;
+        voiceSum += v;
+        dataSum += d;
+        totalSquares += static_cast<Square>(t) * static_cast<Square>(t);
+        voiceSquares += static_cast<Square>(v) * static_cast<Square>(v);
+        dataSquares += static_cast<Square>(d) * static_cast<Square>(d);
+        empty += u & (t == 0);
+        full += t >= capacity;
+    }
+    totals.counted += counted;
+    totals.empty += empty;
+    totals.full += full;
+    totals.totalMin = totalMin;
+    totals.voiceMin = voiceMin;
+    totals.dataMin = dataMin;
+    totals.totalMax = totalMax;
+    totals.voiceMax = voiceMax;
+    totals.dataMax = dataMax;
+    totals.totalSum += totalSum;
+    totals.voiceSum += voiceSum;
+    totals.dataSum += dataSum;
+    totals.totalSquares += static_cast<long long>(totalSquares);
+    totals.voiceSquares += static_cast<long long>(voiceSquares);
+    totals.dataSquares += static_cast<long long>(dataSquares);
+}
+
+ChannelStats CellTower::getChannelStats() const {
+    ChannelStats stats;
+    int channelCount = channels_.getChannelCount();
+    int capacity = channels_.getCapacity();
+    stats.capacity = capacity;
+    stats.busiestTowerId = towerId_;
+    if (channelCount == 0 || capacity <= 0) return stats;
+
+    // Loads come from the allocator and voice counts from the device table, so
+    // no device rows are read. Sums of squares go through 32-bit lanes in
+    // blocks small enough that a block cannot overflow them; loads above
+    // 65535 per channel use 64-bit sums in one scalar pass instead.
+    const int* load = channels_.loads();
+    const int* voiceLoad = table_.channelVoiceCounts();
+    const bool* usable = channels_.usableFlags();
+    // bool lanes do not vectorize; the flags are read as the 0/1 bytes they are.
+    const unsigned char* usableBytes = reinterpret_cast<const unsigned char*>(usable);
+    long long peak = capacity < capacity_ ? capacity : capacity_;
+    LoadTotals totals;
+    totals.totalMin = totals.voiceMin = totals.dataMin = capacity;
+    if (peak <= 0xFFFF) {
+        long long span = peak > 0 ? 0xFFFFFFFFLL / (peak * peak) : channelCount;
+        int block = span < channelCount ? static_cast<int>(span) : channelCount;
+        for (int begin = 0; begin < channelCount; begin += block) {
+            int end = channelCount - begin < block ? channelCount : begin + block;
+            accumulateLoads<unsigned int>(load, voiceLoad, usableBytes, begin, end, capacity, totals);
         }
+    } else {
+        accumulateLoads<long long>(load, voiceLoad, usableBytes, 0, channelCount, capacity, totals);
     }
-    return false;
+    if (totals.counted == 0) return stats;
+
+    stats.total = LoadSummary{ totals.counted, totals.totalMin, totals.totalMax, totals.totalSum, totals.totalSquares };
+    stats.voice = LoadSummary{ totals.counted, totals.voiceMin, totals.voiceMax, totals.voiceSum, totals.voiceSquares };
+    stats.data = LoadSummary{ totals.counted, totals.dataMin, totals.dataMax, totals.dataSum, totals.dataSquares };
+    stats.emptyChannels = totals.empty;
+    stats.fullChannels = totals.full;
+
+    // The histogram scatters into buckets and the busiest channel needs an
+    // index, so both live in a second, scalar loop.
+    for (int c = 0; c < channelCount; ++c) {
+        if (!usable[c]) continue;
+        int t = load[c];
+        if (stats.busiestChannel < 0 && t == totals.totalMax) stats.busiestChannel = c;
+        int bucket = t >= capacity ? ChannelStats::HISTOGRAM_BUCKETS - 1
+                                   : static_cast<int>(static_cast<long long>(t) * 10 / capacity);
+        stats.histogram[bucket]++;
+    }
+    return stats;
+}
+
+UserDevice* CellTower::getDevice(int index) const {
+    if (index < 0 || index >= table_.getCount()) return nullptr;
+    return devices_[index];
+}
+
+UserDevice* CellTower::findDevice(int deviceId) const {
+    int slot = deviceIndex_.find(deviceId);
+    return slot >= 0 ? devices_[slot] : nullptr;
 }
 
-bool CellTower::addUserDevice(UserDevice* device) {
-    if (!device) {
-        io.outputstring("Error: Device cannot be null");
+void CellTower::attach(int deviceId, int channel, ConnectionType type) {
+    int row = table_.append(deviceId, channel, type);
+    devices_[row] = devicePool_.create(&table_, row);
+    deviceIndex_.insert(deviceId, row);
+}
+
+bool CellTower::addUserDevice(int deviceId, ConnectionType type) {
+    if (deviceId <= 0) {
+        io.outputstring("Error: Device ID must be positive");
         io.terminate();
         return false;
     }
 
-    if (deviceCount_ >= MAX_DEVICES || deviceCount_ >= protocol_->calculateMaxUsers()) {
+    if (table_.getCount() >= capacity_) {
         io.outputstring("Error: Tower at capacity: cannot add more devices");
         return false;
     }
 
-    if (!allocateFrequency(device)) {
+    if (deviceIndex_.find(deviceId) >= 0) {
+        io.outputstring("Error: Device ID already attached to tower");
+        io.terminate();
         return false;
     }
 
-    devices_[deviceCount_] = device;
-    deviceCount_++;
-    device->setConnected(true);
+    int channel = channels_.allocate(policy_);
+    if (channel < 0) return false;
+
+    attach(deviceId, channel, type);
     return true;
 }
 
-bool CellTower::removeUserDevice(int deviceId) {
-    for (int i = 0; i < deviceCount_; ++i) {
-        if (devices_[i] && devices_[i]->getDeviceId() == deviceId) {
-            int freq = devices_[i]->getAssignedFrequency();
-            if (freq >= 0 && freq <= MAX_FREQ_KHZ) {
-                frequencyAllocation_[freq]--;
-            }
-
-            devices_[i]->setConnected(false);
-
-            for (int j = i; j < deviceCount_ - 1; ++j) {
-                devices_[j] = devices_[j + 1];
-            }
-            devices_[deviceCount_ - 1] = nullptr;
-            deviceCount_--;
-            return true;
+int CellTower::addUserDevices(const int* deviceIds, const ConnectionType* types, int count) {
+    int added = 0;
+    for (int i = 0; i < count && table_.getCount() < capacity_; ++i) {
+        if (deviceIndex_.find(deviceIds[i]) >= 0) continue;
+
+        int channel = channels_.allocate(policy_);
+        if (channel < 0) break;
+
+        attach(deviceIds[i], channel, types[i]);
+        added++;
+    }
+    return added;
+}
+
+bool CellTower::restoreDevices(const int* deviceIds, const int* channels, const ConnectionType* types,
+                               const bool* connected, int count) {
+    if (table_.getCount() != 0 || count < 0 || count > capacity_) return false;
+    if (!channels_.restoreLoads(channels, count)) return false;
+
+    for (int row = 0; row < count; ++row) {
+        if (deviceIds[row] <= 0 || !deviceIndex_.insert(deviceIds[row], row)) {
+            deviceIndex_.clear();
+            channels_.restoreLoads(channels, 0);
+            return false;
         }
     }
-    return false;
+
+    table_.assign(deviceIds, channels, types, connected, count);
+    for (int row = 0; row < count; ++row) {
+        devices_[row] = devicePool_.create(&table_, row);
+    }
+    return true;
+}
+
+bool CellTower::removeUserDevice(int deviceId) {
+    int row = deviceIndex_.find(deviceId);
+    if (row < 0) return false;
+
+    channels_.release(table_.getChannel(row));
+    devicePool_.release(devices_[row]);
+
+    int last = table_.getCount() - 1;
+    table_.removeRow(row);
+    if (row != last) {
+        devices_[row] = devices_[last];
+        devices_[row]->setRow(row);
+        deviceIndex_.update(table_.getId(row), row);
+    }
+    devices_[last] = nullptr;
+    deviceIndex_.erase(deviceId);
+    return true;
 }
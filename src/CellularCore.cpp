@@ -6,11 +6,20 @@
 #include "../include/basicIO.h"
 
 CellularCore::CellularCore(int coreId)
-    : coreId_(coreId), towerCount_(0), messageQueueSize_(0), totalMessagesProcessed_(0) {
+    : coreId_(coreId), towerCount_(0), towerIndex_(MAX_TOWERS),
+      queueHead_(0), messageQueueSize_(0), totalMessagesGenerated_(0),
+      totalMessagesProcessed_(0), totalMessagesFailed_(0), totalMessagesRejected_(0),
+      reportedProcessed_(0), reportedFailed_(0), workerPool_(nullptr)
+#ifdef SIM_INSTRUMENTATION
+      , instrumentation_(MAX_TOWERS), enqueueTicks_(new unsigned long long[MAX_MESSAGES])
+#endif
+{
     for (int i = 0; i < MAX_TOWERS; ++i) {
         towers_[i] = nullptr;
     }
     messageQueue_ = new Message[MAX_MESSAGES];
+    batchSlot_ = new int[MAX_MESSAGES];
+    batchOrder_ = new int[MAX_MESSAGES];
 }
 
 CellularCore::~CellularCore() {
@@ -21,6 +30,16 @@ CellularCore::~CellularCore() {
         }
     }
     delete[] messageQueue_;
+    delete[] batchSlot_;
+    delete[] batchOrder_;
+    delete workerPool_;
+    SIM_INSTR(delete[] enqueueTicks_);
+}
+
+void CellularCore::setWorkerThreads(int threads) {
+    if (threads == getWorkerThreads()) return;
+    delete workerPool_;
+    workerPool_ = (threads > 1) ? new ThreadPool(threads) : nullptr;
 }
 
 bool CellularCore::addCellTower(CellTower* tower) {
@@ -32,85 +51,315 @@ bool CellularCore::addCellTower(CellTower* tower) {
         io.outputstring("Error: Core at capacity: cannot add more towers\n");
         return false;
     }
+    if (!towerIndex_.insert(tower->getTowerId(), towerCount_)) {
+        io.outputstring("Error: Tower ID already registered with core\n");
+        return false;
+    }
     towers_[towerCount_] = tower;
     towerCount_++;
     return true;
 }
 
 CellTower* CellularCore::getCellTower(int towerId) const {
-    for (int i = 0; i < towerCount_; ++i) {
-        if (towers_[i] && towers_[i]->getTowerId() == towerId) {
-            return towers_[i];
+    int slot = resolveTowerSlot(towerId);
+    return slot >= 0 ? towers_[slot] : nullptr;
+}
+
+void CellularCore::groupMessagesByTower(int* order, int* groupStart) {
+    groupPending(messageQueueSize_, order, groupStart);
+}
+
+void CellularCore::groupPending(int count, int* order, int* groupStart) {
+    int groups = towerCount_ + 1;
+    for (int t = 0; t <= groups; ++t) groupStart[t] = 0;
+
+    int lastTowerId = 0;
+    int lastSlot = towerCount_;
+    bool haveLast = false;
+    for (int i = 0; i < count; ++i) {
+        int towerId = messageQueue_[ringIndex(i)].toTowerId;
+        if (!haveLast || towerId != lastTowerId) {
+            int slot = resolveTowerSlot(towerId);
+            lastSlot = slot >= 0 ? slot : towerCount_;
+            lastTowerId = towerId;
+            haveLast = true;
         }
+        batchSlot_[i] = lastSlot;
+        groupStart[lastSlot + 1]++;
     }
-    return nullptr;
+
+    for (int t = 0; t < groups; ++t) groupStart[t + 1] += groupStart[t];
+
+    // Stable counting sort; groupStart[t] is used as the fill cursor and restored after.
+    for (int i = 0; i < count; ++i) {
+        order[groupStart[batchSlot_[i]]++] = i;
+    }
+    for (int t = groups; t > 0; --t) groupStart[t] = groupStart[t - 1];
+    groupStart[0] = 0;
 }
 
 bool CellularCore::generateMessage(int fromDeviceId, int toTowerId, bool isVoice, const char* payload) {
+    int payloadId = payloads_.intern(payload);
+    if (payloadId < 0) {
+        io.outputstring("Error: Payload table full\n");
+        return false;
+    }
+    return generateMessage(fromDeviceId, toTowerId, isVoice, payloadId);
+}
+
+bool CellularCore::generateMessage(int fromDeviceId, int toTowerId, bool isVoice, int payloadId) {
+    SIM_INSTR(unsigned long long startTicks = Ticks::now());
     if (messageQueueSize_ >= MAX_MESSAGES) {
-        io.outputstring("Error: Message queue full\n");
+        totalMessagesRejected_++;
+        return false;
+    }
+    if (payloadId < 0 || payloadId >= payloads_.getCount()) {
+        io.outputstring("Error: Unknown payload id\n");
         return false;
     }
-    
-    int nextId = static_cast<int>(messageQueueSize_) + 1 + static_cast<int>(totalMessagesProcessed_);
-    Message& m = messageQueue_[messageQueueSize_];
-    m.messageId = nextId;
+
+    totalMessagesGenerated_++;
+    Message& m = messageQueue_[ringIndex(messageQueueSize_)];
+    m.messageId = static_cast<unsigned int>(totalMessagesGenerated_);
     m.fromDeviceId = fromDeviceId;
     m.toTowerId = toTowerId;
+    m.payloadId = static_cast<unsigned short>(payloadId);
     m.isVoice = isVoice;
 
-    for (int i = 0; i < 256; ++i) {
-        m.payload[i] = '\0';
+#ifdef SIM_INSTRUMENTATION
+    unsigned long long endTicks = Ticks::now();
+    enqueueTicks_[ringIndex(messageQueueSize_)] = endTicks;
+    instrumentation_.addPhase(Phase::GENERATION, endTicks - startTicks, 1);
+#endif
+    messageQueueSize_++;
+    return true;
+}
+
+TrafficCounts CellularCore::generateBatch(TrafficPattern& pattern, long long count) {
+    TrafficCounts counts;
+    int cycle = pattern.voiceShare + pattern.dataShare;
+    if (count <= 0 || pattern.voiceShare < 0 || pattern.dataShare < 0 || cycle <= 0
+        || !pattern.senders || pattern.senderCount <= 0) {
+        return counts;
+    }
+    if (pattern.voicePayload < 0 || pattern.voicePayload >= payloads_.getCount()
+        || pattern.dataPayload < 0 || pattern.dataPayload >= payloads_.getCount()) {
+        io.outputstring("Error: Unknown payload id\n");
+        return counts;
     }
+    SIM_INSTR(unsigned long long startTicks = Ticks::now());
 
-    if (payload) {
-        for (int i = 0; i < 255 && payload[i] != '\0'; ++i) {
-            m.payload[i] = payload[i];
+    int room = MAX_MESSAGES - messageQueueSize_;
+    int total = count < room ? static_cast<int>(count) : room;
+    if (total == 0) return counts;
+
+    // The rarer class opens each cycle; a class with share 0 never matches.
+    bool voiceLeads = pattern.voiceShare <= pattern.dataShare;
+    int lead = voiceLeads ? pattern.voiceShare : pattern.dataShare;
+    int phase = static_cast<int>(pattern.position % cycle);
+    int sender = static_cast<int>(pattern.position % pattern.senderCount);
+    unsigned short voicePayload = static_cast<unsigned short>(pattern.voicePayload);
+    unsigned short dataPayload = static_cast<unsigned short>(pattern.dataPayload);
+    unsigned int messageId = static_cast<unsigned int>(totalMessagesGenerated_);
+    long long voice = 0;
+
+    int written = 0;
+    while (written < total) {
+        // Up to the end of the ring, then from its start.
+        int begin = ringIndex(messageQueueSize_ + written);
+        int run = MAX_MESSAGES - begin;
+        if (run > total - written) run = total - written;
+#ifdef SIM_INSTRUMENTATION
+        // Stamp enqueue times every 64 messages as they are written, so queue
+        // waits keep their spread instead of collapsing to one value per batch.
+        if (run > 64) run = 64;
+#endif
+        Message* out = messageQueue_ + begin;
+        for (int i = 0; i < run; ++i) {
+            bool isVoice = (phase < lead) == voiceLeads;
+            out[i].messageId = ++messageId;
+            out[i].fromDeviceId = pattern.senders[sender];
+            out[i].toTowerId = pattern.toTowerId;
+            out[i].payloadId = isVoice ? voicePayload : dataPayload;
+            out[i].isVoice = isVoice;
+            voice += isVoice;
+            if (++phase == cycle) phase = 0;
+            if (++sender == pattern.senderCount) sender = 0;
         }
-        m.payload[255] = '\0';
+#ifdef SIM_INSTRUMENTATION
+        unsigned long long stamped = Ticks::now();
+        for (int i = 0; i < run; ++i) enqueueTicks_[begin + i] = stamped;
+#endif
+        written += run;
     }
 
-    messageQueueSize_++;
-    return true;
+    SIM_INSTR(instrumentation_.addPhase(Phase::GENERATION, Ticks::now() - startTicks, total));
+    messageQueueSize_ += total;
+    totalMessagesGenerated_ += total;
+    pattern.position += total;
+    counts.voice = voice;
+    counts.data = total - voice;
+    return counts;
 }
 
-void CellularCore::processMessages() {
-    if (messageQueueSize_ == 0) {
-        io.outputstring("[Core] No messages to process.\n");
-        return;
+bool CellularCore::restoreQueue(const Message* messages, int count, long long generated,
+                                long long processed, long long failed, long long rejected) {
+    if (messageQueueSize_ != 0 || count < 0 || count > MAX_MESSAGES) return false;
+    for (int i = 0; i < count; ++i) {
+        if (messages[i].payloadId >= payloads_.getCount()) return false;
     }
 
-    int successCount = 0;
-    int failureCount = 0;
+    queueHead_ = 0;
+    for (int i = 0; i < count; ++i) messageQueue_[i] = messages[i];
+    messageQueueSize_ = count;
+    totalMessagesGenerated_ = generated;
+    totalMessagesProcessed_ = processed;
+    totalMessagesFailed_ = failed;
+    totalMessagesRejected_ = rejected;
+    reportedProcessed_ = processed;
+    reportedFailed_ = failed;
+#ifdef SIM_INSTRUMENTATION
+    unsigned long long now = Ticks::now();
+    for (int i = 0; i < count; ++i) enqueueTicks_[i] = now;
+#endif
+    return true;
+}
+
+void CellularCore::tallyRange(int begin, int end, long long& success, long long& failure) const {
+    // Locate the tower group containing begin, then walk groups forward.
+    int t = 0;
+    while (batchGroupStart_[t + 1] <= begin) t++;
+
+    int k = begin;
+    while (k < end) {
+        int groupEnd = batchGroupStart_[t + 1] < end ? batchGroupStart_[t + 1] : end;
+        CellTower* tower = (t < towerCount_) ? towers_[t] : nullptr;
+        SIM_INSTR(long long failureBefore = failure);
+        if (!tower) {
+            failure += groupEnd - k;
+        } else {
+            for (; k < groupEnd; ++k) {
+                const Message& msg = messageQueue_[ringIndex(batchOrder_[k])];
+                if (!tower->hasDevice(msg.fromDeviceId)) {
+                    failure++;
+                    continue;
+                }
 
-    for (int i = 0; i < messageQueueSize_; ++i) {
-        const Message& msg = messageQueue_[i];
-        
-        try {
-            CellTower* tower = getCellTower(msg.toTowerId);
-            if (!tower) {
-                failureCount++;
-                continue;
+                // tower->handleMessage(msg); // could be added in a more advanced version
+                success++;
             }
+        }
+#ifdef SIM_INSTRUMENTATION
+        if (failure != failureBefore) {
+            instrumentation_.addTowerFailures(t < towerCount_ ? t : MAX_TOWERS, failure - failureBefore);
+        }
+#endif
+        k = groupEnd;
+        t++;
+    }
+}
 
-            // tower->handleMessage(msg); // could be added in a more advanced version
-            totalMessagesProcessed_++;
-            successCount++;
+void CellularCore::processShard(int shard, void* context) {
+    ShardJob* job = static_cast<ShardJob*>(context);
+    long long count = job->count;
+    int begin = static_cast<int>(count * shard / job->shards);
+    int end = static_cast<int>(count * (shard + 1) / job->shards);
+    ShardTally& tally = job->tallies[shard];
+    tally.success = 0;
+    tally.failure = 0;
+    if (begin < end) {
+        job->core->tallyRange(begin, end, tally.success, tally.failure);
+    }
+}
 
-        } catch (...) {
-            failureCount++;
+int CellularCore::processPending(int maxMessages) {
+    int count = maxMessages < messageQueueSize_ ? maxMessages : messageQueueSize_;
+    if (count <= 0) return 0;
+
+    long long successCount = 0;
+    long long failureCount = 0;
+
+    SIM_INSTR(unsigned long long routeStart = Ticks::now());
+    groupPending(count, batchOrder_, batchGroupStart_);
+    SIM_INSTR(unsigned long long lookupStart = Ticks::now());
+
+    if (workerPool_ && count >= PARALLEL_THRESHOLD) {
+        int shards = workerPool_->getThreadCount();
+        ShardTally* tallies = new ShardTally[shards];
+        ShardJob job = { this, count, shards, tallies };
+        workerPool_->run(shards, &CellularCore::processShard, &job);
+        for (int w = 0; w < shards; ++w) {
+            successCount += tallies[w].success;
+            failureCount += tallies[w].failure;
         }
+        delete[] tallies;
+    } else {
+        tallyRange(0, count, successCount, failureCount);
+    }
+
+#ifdef SIM_INSTRUMENTATION
+    unsigned long long doneTicks = Ticks::now();
+    instrumentation_.addPhase(Phase::ROUTING, lookupStart - routeStart, count);
+    instrumentation_.addPhase(Phase::TOWER_LOOKUP, doneTicks - lookupStart, count);
+    for (int t = 0; t <= towerCount_; ++t) {
+        int messages = batchGroupStart_[t + 1] - batchGroupStart_[t];
+        if (messages > 0) instrumentation_.addTowerMessages(t < towerCount_ ? t : MAX_TOWERS, messages);
+    }
+    // Queue wait: generation to the end of this batch's validation.
+    for (int i = 0; i < count; ++i) {
+        int index = ringIndex(i);
+        instrumentation_.recordLatency(messageQueue_[index].isVoice,
+                                       Ticks::toNanoseconds(doneTicks - enqueueTicks_[index]));
     }
-    
+#endif
+
+    totalMessagesProcessed_ += successCount;
+    totalMessagesFailed_ += failureCount;
+    queueHead_ = ringIndex(count);
+    messageQueueSize_ -= count;
+    return count;
+}
+
+void CellularCore::processMessages() {
+    processPending(messageQueueSize_);
+
+    long long successCount = totalMessagesProcessed_ - reportedProcessed_;
+    long long failureCount = totalMessagesFailed_ - reportedFailed_;
+    reportedProcessed_ = totalMessagesProcessed_;
+    reportedFailed_ = totalMessagesFailed_;
+
+    if (successCount == 0 && failureCount == 0) {
+        io.outputstring("[Core] No messages to process.\n");
+        return;
+    }
+
     io.outputstring("[Core] Successfully processed: ");
-    io.outputint(successCount);
+    io.outputlong(successCount);
     io.outputstring(" messages\n");
-    
+
     if (failureCount > 0) {
         io.outputstring("[Core] Failed to process: ");
-        io.outputint(failureCount);
+        io.outputlong(failureCount);
         io.outputstring(" messages\n");
     }
-    
-    messageQueueSize_ = 0;
+}
+
+const CoreInstrumentation* CellularCore::getInstrumentation() const {
+#ifdef SIM_INSTRUMENTATION
+    return &instrumentation_;
+#else
+    return nullptr;
+#endif
+}
+
+void CellularCore::resetInstrumentation() {
+    SIM_INSTR(instrumentation_.reset());
+}
+
+void CellularCore::dumpInstrumentation() const {
+#ifdef SIM_INSTRUMENTATION
+    int towerIds[MAX_TOWERS];
+    for (int t = 0; t < towerCount_; ++t) towerIds[t] = towers_[t]->getTowerId();
+    instrumentation_.dump(coreId_, towerIds, towerCount_);
+#endif
 }
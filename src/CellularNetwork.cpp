@@ -0,0 +1,276 @@
+/* CellularNetwork.cpp
+ * Implementation of CellularNetwork.
+ */
+
+#include "../include/CellularNetwork.h"
+#include "../include/Clock.h"
+#include "../include/Snapshot.h"
+#include "../include/ThreadPool.h"
+#include "../include/basicIO.h"
+
+CellularNetwork::CellularNetwork(const CommunicationProtocol* protocol, int coreCount,
+                                 int firstTowerId, BalancingPolicy policy)
+    : protocol_(protocol), coreCount_(coreCount), policy_(policy), nextCore_(0),
+      deviceCore_(protocol ? protocol->calculateMaxUsers() : 0), deviceCount_(0),
+      maxDevices_(protocol ? protocol->calculateMaxUsers() : 0) {
+    if (coreCount_ < 1) coreCount_ = 1;
+    if (coreCount_ > MAX_CORES) coreCount_ = MAX_CORES;
+
+    for (int c = 0; c < coreCount_; ++c) {
+        cores_[c] = new CellularCore(c + 1);
+        towers_[c] = new CellTower(firstTowerId + c, protocol_);
+        cores_[c]->addCellTower(towers_[c]);
+        stats_[c] = CoreStats{0, 0, 0, 0, 0, 0};
+    }
+
+    // Towers are capped at CellTower::MAX_DEVICES, so a large protocol can
+    // promise more devices than the cores hold between them.
+    long long room = 0;
+    for (int c = 0; c < coreCount_; ++c) room += towers_[c]->getCapacity();
+    if (room < maxDevices_) maxDevices_ = static_cast<int>(room);
+}
+
+CellularNetwork::~CellularNetwork() {
+    for (int c = 0; c < coreCount_; ++c) {
+        delete cores_[c]; // also deletes its tower
+    }
+}
+
+CellularCore* CellularNetwork::getCore(int index) const {
+    if (index < 0 || index >= coreCount_) return nullptr;
+    return cores_[index];
+}
+
+CellTower* CellularNetwork::getTower(int index) const {
+    if (index < 0 || index >= coreCount_) return nullptr;
+    return towers_[index];
+}
+
+int CellularNetwork::pickCore(int deviceId) const {
+    switch (policy_) {
+    case BalancingPolicy::LEAST_LOADED: {
+        int best = 0;
+        for (int c = 1; c < coreCount_; ++c) {
+            if (towers_[c]->getDeviceCount() < towers_[best]->getDeviceCount()) best = c;
+        }
+        return best;
+    }
+    case BalancingPolicy::HASHED:
+        return static_cast<int>(((static_cast<unsigned int>(deviceId) * 2654435761u) >> 8)
+                                % static_cast<unsigned int>(coreCount_));
+    case BalancingPolicy::ROUND_ROBIN:
+    default:
+        return nextCore_;
+    }
+}
+
+// Attaches quietly to the policy's core, or to the next core with room when that
+// one is full. The round-robin cursor moves on whether or not a core took it.
+int CellularNetwork::attach(int deviceId, ConnectionType type) {
+    int first = pickCore(deviceId);
+    if (policy_ == BalancingPolicy::ROUND_ROBIN) {
+        nextCore_ = (first + 1) % coreCount_;
+    }
+    for (int k = 0; k < coreCount_; ++k) {
+        int core = (first + k) % coreCount_;
+        if (towers_[core]->addUserDevices(&deviceId, &type, 1) == 0) continue;
+        if (policy_ == BalancingPolicy::ROUND_ROBIN) {
+            nextCore_ = (core + 1) % coreCount_;
+        }
+        deviceCore_.insert(deviceId, core);
+        deviceCount_++;
+        return core;
+    }
+    return -1;
+}
+
+bool CellularNetwork::addUserDevice(int deviceId, ConnectionType type) {
+    if (deviceCount_ >= maxDevices_) {
+        io.outputstring("Error: Network at capacity: cannot add more devices");
+        return false;
+    }
+    if (deviceCore_.find(deviceId) >= 0) {
+        io.outputstring("Error: Device ID already attached to network");
+        io.terminate();
+        return false;
+    }
+    if (attach(deviceId, type) < 0) {
+        io.outputstring("Error: No core has room for device");
+        io.terminate();
+        return false;
+    }
+    return true;
+}
+
+int CellularNetwork::addUserDevices(const int* deviceIds, const ConnectionType* types, int count) {
+    int added = 0;
+    for (int i = 0; i < count && deviceCount_ < maxDevices_; ++i) {
+        if (deviceCore_.find(deviceIds[i]) >= 0) continue;
+        if (attach(deviceIds[i], types[i]) >= 0) added++;
+    }
+    return added;
+}
+
+bool CellularNetwork::saveSnapshot(const char* path) const {
+    return Snapshot::save(path, cores_, coreCount_);
+}
+
+bool CellularNetwork::loadSnapshot(const char* path) {
+    if (deviceCount_ != 0 || !Snapshot::load(path, cores_, coreCount_)) return false;
+
+    for (int c = 0; c < coreCount_; ++c) {
+        const int* ids = towers_[c]->getDeviceTable().ids();
+        int count = towers_[c]->getDeviceCount();
+        for (int i = 0; i < count; ++i) {
+            if (deviceCount_ >= maxDevices_ || !deviceCore_.insert(ids[i], c)) return false;
+            deviceCount_++;
+        }
+    }
+    nextCore_ = deviceCount_ % coreCount_;
+    return true;
+}
+
+void CellularNetwork::runCore(int core, void* context) {
+    RunJob* job = static_cast<RunJob*>(context);
+    CellularNetwork* net = job->network;
+    CellularCore* cc = net->cores_[core];
+    CellTower* tower = net->towers_[core];
+    CoreStats& stats = net->stats_[core];
+
+    int devices = tower->getDeviceCount();
+    stats.deviceCount = devices;
+    stats.messages = 0;
+    stats.voiceMessages = 0;
+    stats.elapsedNs = 0;
+    if (devices == 0 || net->deviceCount_ == 0) {
+        stats.processed = 0;
+        stats.failed = 0;
+        return;
+    }
+
+    // Share of the traffic proportional to this core's devices; cores before this
+    // one get the same rounding so the shares add up to totalMessages exactly.
+    long long devicesBefore = 0;
+    for (int c = 0; c < core; ++c) devicesBefore += net->towers_[c]->getDeviceCount();
+    long long first = job->totalMessages * devicesBefore / net->deviceCount_;
+    long long last = job->totalMessages * (devicesBefore + devices) / net->deviceCount_;
+    long long messages = last - first;
+
+    long long processedBefore = cc->getTotalMessagesProcessed();
+    long long failedBefore = cc->getTotalMessagesFailed();
+    TrafficPattern pattern;
+    pattern.voiceShare = job->voiceShare;
+    pattern.dataShare = job->dataShare;
+    pattern.senders = tower->getDeviceTable().ids();
+    pattern.senderCount = devices;
+    pattern.toTowerId = tower->getTowerId();
+    pattern.voicePayload = cc->internPayload("Voice call");
+    pattern.dataPayload = cc->internPayload("Data packet");
+
+    long long start = Clock::nowNanoseconds();
+    long long voice = 0;
+    long long remaining = messages;
+    while (remaining > 0) {
+        if (cc->isQueueFull()) {
+            cc->processPending(CellularCore::MAX_MESSAGES);
+        }
+        TrafficCounts batch = cc->generateBatch(pattern, remaining);
+        if (batch.voice + batch.data == 0) break; // invalid pattern
+        voice += batch.voice;
+        remaining -= batch.voice + batch.data;
+    }
+    messages -= remaining;
+    cc->processPending(CellularCore::MAX_MESSAGES);
+    stats.elapsedNs = Clock::nowNanoseconds() - start;
+
+    stats.messages = messages;
+    stats.voiceMessages = voice;
+    stats.processed = cc->getTotalMessagesProcessed() - processedBefore;
+    stats.failed = cc->getTotalMessagesFailed() - failedBefore;
+}
+
+void CellularNetwork::run(long long totalMessages, int voiceShare, int dataShare, int threads) {
+    if (threads <= 0) {
+        int hw = ThreadPool::hardwareThreads();
+        threads = coreCount_ < hw ? coreCount_ : hw;
+    }
+    RunJob job = { this, totalMessages, voiceShare, dataShare };
+    ThreadPool pool(threads);
+    pool.run(coreCount_, &CellularNetwork::runCore, &job);
+}
+
+long long CellularNetwork::getTotalProcessed() const {
+    long long total = 0;
+    for (int c = 0; c < coreCount_; ++c) total += stats_[c].processed;
+    return total;
+}
+
+long long CellularNetwork::getTotalMessages() const {
+    long long total = 0;
+    for (int c = 0; c < coreCount_; ++c) total += stats_[c].messages;
+    return total;
+}
+
+long long CellularNetwork::getTotalVoice() const {
+    long long total = 0;
+    for (int c = 0; c < coreCount_; ++c) total += stats_[c].voiceMessages;
+    return total;
+}
+
+long long CellularNetwork::getTotalFailed() const {
+    long long total = 0;
+    for (int c = 0; c < coreCount_; ++c) total += stats_[c].failed;
+    return total;
+}
+
+void CellularNetwork::printReport() const {
+    long long totalMessages = 0;
+    long long maxMessages = 0;
+    long long totalNs = 0;
+    long long maxNs = 0;
+
+    for (int c = 0; c < coreCount_; ++c) {
+        const CoreStats& s = stats_[c];
+        io.outputstring("Core "); io.outputint(c + 1);
+        io.outputstring(" (tower "); io.outputint(towers_[c]->getTowerId()); io.outputstring("): ");
+        io.outputint(s.deviceCount); io.outputstring(" devices, ");
+        io.outputlong(s.messages); io.outputstring(" messages, ");
+        io.outputlong(s.elapsedNs / 1000); io.outputstring(" us, ");
+        io.outputlong(Clock::ratePerSecond(s.messages, s.elapsedNs)); io.outputstring(" msg/s\n");
+
+        totalMessages += s.messages;
+        totalNs += s.elapsedNs;
+        if (s.messages > maxMessages) maxMessages = s.messages;
+        if (s.elapsedNs > maxNs) maxNs = s.elapsedNs;
+    }
+
+    if (coreCount_ > 1 && totalMessages > 0) {
+        // Imbalance = how far the busiest core sits above the mean, in percent.
+        io.outputstring("Load imbalance (messages, max vs mean): ");
+        io.outputlong(maxMessages * coreCount_ * 100 / totalMessages - 100);
+        io.outputstring("%\n");
+    }
+    if (totalNs > 0) {
+        if (coreCount_ > 1) {
+            io.outputstring("Load imbalance (time, max vs mean): ");
+            io.outputlong(maxNs * coreCount_ * 100 / totalNs - 100);
+            io.outputstring("%\n");
+        }
+        io.outputstring("Aggregate throughput: ");
+        io.outputlong(Clock::ratePerSecond(totalMessages, maxNs));
+        io.outputstring(" msg/s\n");
+    }
+
+    io.outputstring("[Core] Successfully processed: ");
+    io.outputlong(getTotalProcessed());
+    io.outputstring(" messages\n");
+    if (getTotalFailed() > 0) {
+        io.outputstring("[Core] Failed to process: ");
+        io.outputlong(getTotalFailed());
+        io.outputstring(" messages\n");
+    }
+}
+
+void CellularNetwork::dumpInstrumentation() const {
+    for (int c = 0; c < coreCount_; ++c) cores_[c]->dumpInstrumentation();
+}
@@ -0,0 +1,222 @@
+/* ChannelAllocator.cpp
+ * Implementation of ChannelAllocator.
+ */
+
+#include "../include/ChannelAllocator.h"
+
+ChannelAllocator::ChannelAllocator(int channelCount, int capacityPerChannel)
+    : channelCount_(channelCount > 0 ? channelCount : 0),
+      capacity_(capacityPerChannel > 0 ? capacityPerChannel : 0),
+      levelCount_(0), heapSize_(0) {
+    int n = channelCount_ > 0 ? channelCount_ : 1;
+    load_ = new int[n];
+    usable_ = new bool[n];
+    heap_ = new int[n];
+    heapPos_ = new int[n];
+
+    int bits = n;
+    while (levelCount_ < MAX_LEVELS) {
+        int words = (bits + 63) / 64;
+        levels_[levelCount_] = new unsigned long long[words];
+        levelWords_[levelCount_] = words;
+        for (int w = 0; w < words; ++w) levels_[levelCount_][w] = 0;
+        levelCount_++;
+        if (words == 1) break;
+        bits = words;
+    }
+
+    for (int c = 0; c < channelCount_; ++c) {
+        load_[c] = 0;
+        usable_[c] = true;
+        heapPos_[c] = -1;
+        if (capacity_ > 0) {
+            setBit(c);
+            heap_[heapSize_] = c; // ascending index with equal load is already a valid heap
+            heapPos_[c] = heapSize_++;
+        }
+    }
+}
+
+ChannelAllocator::~ChannelAllocator() {
+    for (int l = 0; l < levelCount_; ++l) delete[] levels_[l];
+    delete[] heapPos_;
+    delete[] heap_;
+    delete[] usable_;
+    delete[] load_;
+}
+
+int ChannelAllocator::getLoad(int channel) const {
+    if (channel < 0 || channel >= channelCount_) return 0;
+    return load_[channel];
+}
+
+long long ChannelAllocator::getMemoryUsage() const {
+    long long n = channelCount_ > 0 ? channelCount_ : 1;
+    long long bytes = n * (sizeof(int) * 3 + sizeof(bool));
+    for (int l = 0; l < levelCount_; ++l) {
+        bytes += static_cast<long long>(levelWords_[l]) * sizeof(unsigned long long);
+    }
+    return bytes;
+}
+
+void ChannelAllocator::setBit(int channel) {
+    int index = channel;
+    for (int l = 0; l < levelCount_; ++l) {
+        unsigned long long& word = levels_[l][index >> 6];
+        bool wasEmpty = (word == 0);
+        word |= 1ULL << (index & 63);
+        if (!wasEmpty) return;
+        index >>= 6;
+    }
+}
+
+void ChannelAllocator::clearBit(int channel) {
+    int index = channel;
+    for (int l = 0; l < levelCount_; ++l) {
+        unsigned long long& word = levels_[l][index >> 6];
+        word &= ~(1ULL << (index & 63));
+        if (word != 0) return;
+        index >>= 6;
+    }
+}
+
+int ChannelAllocator::findFirstSet() const {
+    int top = levelCount_ - 1;
+    if (levels_[top][0] == 0) return -1;
+    int index = 0;
+    for (int l = top; l >= 0; --l) {
+        unsigned long long word = levels_[l][index];
+        index = index * 64 + __builtin_ctzll(word);
+    }
+    return index;
+}
+
+bool ChannelAllocator::heapLess(int a, int b) const {
+    if (load_[a] != load_[b]) return load_[a] < load_[b];
+    return a < b;
+}
+
+void ChannelAllocator::heapSwap(int i, int j) {
+    int a = heap_[i];
+    int b = heap_[j];
+    heap_[i] = b;
+    heap_[j] = a;
+    heapPos_[b] = i;
+    heapPos_[a] = j;
+}
+
+void ChannelAllocator::siftUp(int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!heapLess(heap_[pos], heap_[parent])) break;
+        heapSwap(pos, parent);
+        pos = parent;
+    }
+}
+
+void ChannelAllocator::siftDown(int pos) {
+    while (true) {
+        int left = 2 * pos + 1;
+        if (left >= heapSize_) break;
+        int best = left;
+        int right = left + 1;
+        if (right < heapSize_ && heapLess(heap_[right], heap_[left])) best = right;
+        if (!heapLess(heap_[best], heap_[pos])) break;
+        heapSwap(pos, best);
+        pos = best;
+    }
+}
+
+void ChannelAllocator::heapInsert(int channel) {
+    heap_[heapSize_] = channel;
+    heapPos_[channel] = heapSize_;
+    heapSize_++;
+    siftUp(heapSize_ - 1);
+}
+
+void ChannelAllocator::heapRemove(int channel) {
+    int pos = heapPos_[channel];
+    if (pos < 0) return;
+    heapSize_--;
+    if (pos != heapSize_) {
+        int moved = heap_[heapSize_];
+        heapSwap(pos, heapSize_);
+        siftUp(pos);
+        siftDown(heapPos_[moved]);
+    }
+    heapPos_[channel] = -1;
+}
+
+void ChannelAllocator::excludeChannel(int channel) {
+    if (channel < 0 || channel >= channelCount_ || !usable_[channel]) return;
+    if (hasRoom(channel)) {
+        clearBit(channel);
+        heapRemove(channel);
+    }
+    usable_[channel] = false;
+}
+
+int ChannelAllocator::allocate(AllocationPolicy policy) {
+    int channel = (policy == AllocationPolicy::LEAST_LOADED)
+                      ? (heapSize_ > 0 ? heap_[0] : -1)
+                      : findFirstSet();
+    if (channel < 0) return -1;
+
+    load_[channel]++;
+    if (load_[channel] >= capacity_) {
+        clearBit(channel);
+        heapRemove(channel);
+    } else {
+        siftDown(heapPos_[channel]);
+    }
+    return channel;
+}
+
+void ChannelAllocator::release(int channel) {
+    if (channel < 0 || channel >= channelCount_ || load_[channel] <= 0) return;
+
+    bool wasFull = !hasRoom(channel);
+    load_[channel]--;
+    if (!usable_[channel]) return;
+    if (wasFull) {
+        setBit(channel);
+        heapInsert(channel);
+    } else {
+        siftUp(heapPos_[channel]);
+    }
+}
+
+bool ChannelAllocator::restoreLoads(const int* rowChannels, int rows) {
+    int* counts = new int[channelCount_ > 0 ? channelCount_ : 1];
+    for (int c = 0; c < channelCount_; ++c) counts[c] = 0;
+    bool valid = true;
+    for (int i = 0; i < rows; ++i) {
+        int channel = rowChannels[i];
+        if (channel < 0 || channel >= channelCount_ || !usable_[channel] || ++counts[channel] > capacity_) {
+            valid = false;
+            break;
+        }
+    }
+    if (!valid) {
+        delete[] counts;
+        return false;
+    }
+
+    for (int l = 0; l < levelCount_; ++l) {
+        for (int w = 0; w < levelWords_[l]; ++w) levels_[l][w] = 0;
+    }
+    heapSize_ = 0;
+    for (int c = 0; c < channelCount_; ++c) {
+        load_[c] = counts[c];
+        heapPos_[c] = -1;
+        if (hasRoom(c)) {
+            setBit(c);
+            heap_[heapSize_] = c;
+            heapPos_[c] = heapSize_++;
+        }
+    }
+    for (int pos = heapSize_ / 2 - 1; pos >= 0; --pos) siftDown(pos);
+
+    delete[] counts;
+    return true;
+}
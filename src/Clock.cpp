@@ -0,0 +1,26 @@
+/* Clock.cpp
+ * Implementation of Clock.
+ */
+
+#include "../include/Clock.h"
+
+#define SYS_CLOCK_GETTIME 228
+#define CLOCK_MONOTONIC 1
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+struct KernelTimespec {
+    long seconds;
+    long nanoseconds;
+};
+
+long long Clock::nowNanoseconds() {
+    KernelTimespec ts = {0, 0};
+    syscall3(SYS_CLOCK_GETTIME, CLOCK_MONOTONIC, (long)&ts, 0);
+    return static_cast<long long>(ts.seconds) * 1000000000LL + ts.nanoseconds;
+}
+
+long long Clock::ratePerSecond(long long events, long long elapsedNs) {
+    if (elapsedNs <= 0) return 0;
+    return static_cast<long long>(static_cast<double>(events) * 1e9 / static_cast<double>(elapsedNs));
+}
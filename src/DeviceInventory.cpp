@@ -0,0 +1,238 @@
+/* DeviceInventory.cpp
+ * Implementation of DeviceInventory.
+ */
+
+#include "../include/DeviceInventory.h"
+#include "../include/ThreadPool.h"
+
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define SYS_FSTAT 5
+#define SYS_MMAP 9
+#define SYS_MUNMAP 11
+#define SYS_MADVISE 28
+#define O_RDONLY 0
+#define PROT_READ 1
+#define MAP_PRIVATE 2
+#define MADV_SEQUENTIAL 2
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+extern "C" long syscall6(long number, long arg1, long arg2, long arg3, long arg4, long arg5, long arg6);
+
+// x86_64 struct stat; only st_size is read.
+struct KernelStat {
+    unsigned long dev;
+    unsigned long ino;
+    unsigned long nlink;
+    unsigned int mode;
+    unsigned int uid;
+    unsigned int gid;
+    unsigned int pad0;
+    unsigned long rdev;
+    long size;
+    long blksize;
+    long blocks;
+    unsigned long times[6];
+    long reserved[3];
+};
+
+struct DeviceInventory::Chunk {
+    const char* data;
+    long long begin;
+    long long end;
+    long long firstLine;   // 1-based line number of data[begin]
+    long long lines;       // filled by the counting pass
+    int outStart;          // first slot in ids/types for this chunk
+    int rows;              // valid rows written
+    long long badCount;
+    long long badLines[MAX_REPORTED_ERRORS];
+    int badStored;
+    int* ids;
+    ConnectionType* types;
+};
+
+namespace {
+
+struct LoadJob {
+    void* chunks;
+    bool counting;
+};
+
+enum RowStatus { ROW_OK, ROW_BLANK, ROW_BAD };
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Parses one line starting at p and leaves p just past its newline.
+RowStatus parseRow(const char*& p, const char* end, int& id, ConnectionType& type) {
+    const char* s = p;
+    while (s < end && isBlank(*s)) ++s;
+    if (s == end || *s == '\n') {
+        p = (s < end) ? s + 1 : s;
+        return ROW_BLANK;
+    }
+
+    RowStatus status = ROW_BAD;
+    long long value = 0;
+    const char* digits = s;
+    while (s < end && *s >= '0' && *s <= '9' && value <= 2147483647LL) {
+        value = value * 10 + (*s - '0');
+        ++s;
+    }
+    if (s != digits && value > 0 && value <= 2147483647LL) {
+        while (s < end && isBlank(*s)) ++s;
+        if (s < end && *s == ',') {
+            ++s;
+            while (s < end && isBlank(*s)) ++s;
+            if (s < end && (*s == 'D' || *s == 'd' || *s == 'V' || *s == 'v')) {
+                type = (*s == 'V' || *s == 'v') ? ConnectionType::VOICE : ConnectionType::DATA;
+                ++s;
+                while (s < end && isBlank(*s)) ++s;
+                if (s == end || *s == '\n') {
+                    id = static_cast<int>(value);
+                    status = ROW_OK;
+                }
+            }
+        }
+    }
+
+    while (s < end && *s != '\n') ++s;
+    p = (s < end) ? s + 1 : s;
+    return status;
+}
+
+} // namespace
+
+DeviceInventory::DeviceInventory()
+    : ids_(nullptr), types_(nullptr), count_(0), badRowCount_(0), badRowsStored_(0) {}
+
+DeviceInventory::~DeviceInventory() {
+    clear();
+}
+
+void DeviceInventory::clear() {
+    delete[] ids_;
+    delete[] types_;
+    ids_ = nullptr;
+    types_ = nullptr;
+    count_ = 0;
+    badRowCount_ = 0;
+    badRowsStored_ = 0;
+}
+
+void DeviceInventory::parseChunk(int index, void* context) {
+    LoadJob* job = static_cast<LoadJob*>(context);
+    Chunk& c = static_cast<Chunk*>(job->chunks)[index];
+    const char* p = c.data + c.begin;
+    const char* end = c.data + c.end;
+
+    if (job->counting) {
+        long long lines = 0;
+        for (const char* q = p; q < end; ++q) lines += (*q == '\n');
+        if (c.end > c.begin && c.data[c.end - 1] != '\n') lines++;
+        c.lines = lines;
+        return;
+    }
+
+    long long line = c.firstLine;
+    int rows = 0;
+    while (p < end) {
+        int id = 0;
+        ConnectionType type = ConnectionType::DATA;
+        RowStatus status = parseRow(p, end, id, type);
+        if (status == ROW_OK) {
+            c.ids[c.outStart + rows] = id;
+            c.types[c.outStart + rows] = type;
+            rows++;
+        } else if (status == ROW_BAD) {
+            if (c.badStored < MAX_REPORTED_ERRORS) c.badLines[c.badStored++] = line;
+            c.badCount++;
+        }
+        line++;
+    }
+    c.rows = rows;
+}
+
+bool DeviceInventory::loadFile(const char* path, int threads) {
+    clear();
+
+    long fd = syscall3(SYS_OPEN, (long)path, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    KernelStat st;
+    if (syscall3(SYS_FSTAT, fd, (long)&st, 0) < 0) {
+        syscall3(SYS_CLOSE, fd, 0, 0);
+        return false;
+    }
+    long long size = st.size;
+    if (size <= 0) {
+        syscall3(SYS_CLOSE, fd, 0, 0);
+        ids_ = new int[1];
+        types_ = new ConnectionType[1];
+        return true;
+    }
+
+    long mapped = syscall6(SYS_MMAP, 0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    if (mapped < 0 && mapped > -4096) return false;
+    syscall3(SYS_MADVISE, mapped, size, MADV_SEQUENTIAL);
+    const char* data = reinterpret_cast<const char*>(mapped);
+
+    if (threads <= 0) threads = ThreadPool::hardwareThreads();
+    long long maxChunks = size / MIN_CHUNK_BYTES + 1;
+    int chunkCount = threads < maxChunks ? threads : static_cast<int>(maxChunks);
+
+    // Cut at line boundaries: each chunk ends just after a newline (or at EOF).
+    Chunk* chunks = new Chunk[chunkCount];
+    long long begin = 0;
+    for (int i = 0; i < chunkCount; ++i) {
+        long long end = (i == chunkCount - 1) ? size : size * (i + 1) / chunkCount;
+        if (end < begin) end = begin;
+        while (end < size && end > 0 && data[end - 1] != '\n') end++;
+        chunks[i].data = data;
+        chunks[i].begin = begin;
+        chunks[i].end = end;
+        chunks[i].rows = 0;
+        chunks[i].badCount = 0;
+        chunks[i].badStored = 0;
+        begin = end;
+    }
+
+    ThreadPool pool(chunkCount);
+    LoadJob job = { chunks, true };
+    pool.run(chunkCount, &DeviceInventory::parseChunk, &job);
+
+    long long totalLines = 0;
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks[i].firstLine = totalLines + 1;
+        chunks[i].outStart = static_cast<int>(totalLines);
+        totalLines += chunks[i].lines;
+    }
+
+    ids_ = new int[totalLines > 0 ? totalLines : 1];
+    types_ = new ConnectionType[totalLines > 0 ? totalLines : 1];
+    for (int i = 0; i < chunkCount; ++i) {
+        chunks[i].ids = ids_;
+        chunks[i].types = types_;
+    }
+
+    job.counting = false;
+    pool.run(chunkCount, &DeviceInventory::parseChunk, &job);
+
+    // Compact each chunk's rows down behind the previous chunk's, in file order.
+    for (int i = 0; i < chunkCount; ++i) {
+        const Chunk& c = chunks[i];
+        for (int r = 0; r < c.rows; ++r) {
+            ids_[count_ + r] = ids_[c.outStart + r];
+            types_[count_ + r] = types_[c.outStart + r];
+        }
+        count_ += c.rows;
+        badRowCount_ += c.badCount;
+        for (int b = 0; b < c.badStored && badRowsStored_ < MAX_REPORTED_ERRORS; ++b) {
+            badRowLines_[badRowsStored_++] = c.badLines[b];
+        }
+    }
+
+    delete[] chunks;
+    syscall3(SYS_MUNMAP, mapped, size, 0);
+    return true;
+}
@@ -0,0 +1,73 @@
+/* DevicePool.cpp
+ * Implementation of DevicePool.
+ */
+
+#include "../include/DevicePool.h"
+
+#include <new>         // placement new
+#include <type_traits>
+
+// clear() drops whole slabs without visiting each device.
+static_assert(std::is_trivially_destructible<UserDevice>::value,
+              "DevicePool frees slabs without running UserDevice destructors");
+
+DevicePool::DevicePool(int slabSlots)
+    : slabSlots_(slabSlots > 0 ? slabSlots : DEFAULT_SLAB_SLOTS), slabs_(nullptr), slabCount_(0),
+      slabCapacity_(0), usedInLastSlab_(0), freeList_(nullptr), liveCount_(0) {}
+
+DevicePool::~DevicePool() {
+    clear();
+}
+
+long long DevicePool::getMemoryUsage() const {
+    return static_cast<long long>(slabCount_) * slabSlots_ * sizeof(Slot)
+         + static_cast<long long>(slabCapacity_) * sizeof(Slot*);
+}
+
+DevicePool::Slot* DevicePool::takeSlot() {
+    if (freeList_) {
+        Slot* slot = freeList_;
+        freeList_ = slot->nextFree;
+        return slot;
+    }
+
+    if (slabCount_ == 0 || usedInLastSlab_ == slabSlots_) {
+        if (slabCount_ == slabCapacity_) {
+            int newCapacity = slabCapacity_ > 0 ? slabCapacity_ * 2 : 4;
+            Slot** grown = new Slot*[newCapacity];
+            for (int i = 0; i < slabCount_; ++i) grown[i] = slabs_[i];
+            delete[] slabs_;
+            slabs_ = grown;
+            slabCapacity_ = newCapacity;
+        }
+        slabs_[slabCount_++] = new Slot[slabSlots_];
+        usedInLastSlab_ = 0;
+    }
+    return &slabs_[slabCount_ - 1][usedInLastSlab_++];
+}
+
+UserDevice* DevicePool::create(DeviceTable* table, int row) {
+    Slot* slot = takeSlot();
+    liveCount_++;
+    return new (slot->storage) UserDevice(table, row);
+}
+
+void DevicePool::release(UserDevice* device) {
+    if (!device) return;
+    device->~UserDevice();
+    Slot* slot = reinterpret_cast<Slot*>(device);
+    slot->nextFree = freeList_;
+    freeList_ = slot;
+    liveCount_--;
+}
+
+void DevicePool::clear() {
+    for (int i = 0; i < slabCount_; ++i) delete[] slabs_[i];
+    delete[] slabs_;
+    slabs_ = nullptr;
+    slabCount_ = 0;
+    slabCapacity_ = 0;
+    usedInLastSlab_ = 0;
+    freeList_ = nullptr;
+    liveCount_ = 0;
+}
@@ -0,0 +1,88 @@
+/* DeviceTable.cpp
+ * Implementation of DeviceTable.
+ */
+
+#include "../include/DeviceTable.h"
+
+DeviceTable::DeviceTable(int capacity, const int* channelFrequency, int channelCount)
+    : capacity_(capacity > 0 ? capacity : 0), count_(0), channelFrequency_(channelFrequency),
+      channelCount_(channelCount > 0 ? channelCount : 0) {
+    int n = capacity_ > 0 ? capacity_ : 1;
+    ids_ = new int[n];
+    channels_ = new int[n];
+    types_ = new ConnectionType[n];
+    connected_ = new bool[n];
+    channelVoice_ = new int[channelCount_ > 0 ? channelCount_ : 1];
+    for (int c = 0; c < channelCount_; ++c) channelVoice_[c] = 0;
+}
+
+DeviceTable::~DeviceTable() {
+    delete[] channelVoice_;
+    delete[] connected_;
+    delete[] types_;
+    delete[] channels_;
+    delete[] ids_;
+}
+
+long long DeviceTable::getMemoryUsage() const {
+    long long n = capacity_ > 0 ? capacity_ : 1;
+    return n * (sizeof(int) * 2 + sizeof(ConnectionType) + sizeof(bool))
+         + static_cast<long long>(channelCount_ > 0 ? channelCount_ : 1) * sizeof(int);
+}
+
+void DeviceTable::setType(int row, ConnectionType type) {
+    int channel = channels_[row];
+    if (channel >= 0) {
+        channelVoice_[channel] += (type == ConnectionType::VOICE) - (types_[row] == ConnectionType::VOICE);
+    }
+    types_[row] = type;
+}
+
+int DeviceTable::append(int deviceId, int channel, ConnectionType type) {
+    int row = count_++;
+    ids_[row] = deviceId;
+    channels_[row] = channel;
+    types_[row] = type;
+    connected_[row] = true;
+    if (channel >= 0) channelVoice_[channel] += type == ConnectionType::VOICE;
+    return row;
+}
+
+void DeviceTable::assign(const int* ids, const int* channels, const ConnectionType* types,
+                         const bool* connected, int count) {
+    count_ = count < capacity_ ? count : capacity_;
+    for (int i = 0; i < count_; ++i) ids_[i] = ids[i];
+    for (int i = 0; i < count_; ++i) channels_[i] = channels[i];
+    for (int i = 0; i < count_; ++i) types_[i] = types[i];
+    for (int i = 0; i < count_; ++i) connected_[i] = connected[i];
+    for (int c = 0; c < channelCount_; ++c) channelVoice_[c] = 0;
+    for (int i = 0; i < count_; ++i) {
+        if (channels_[i] >= 0) channelVoice_[channels_[i]] += types_[i] == ConnectionType::VOICE;
+    }
+}
+
+void DeviceTable::removeRow(int row) {
+    if (channels_[row] >= 0) channelVoice_[channels_[row]] -= types_[row] == ConnectionType::VOICE;
+    int last = --count_;
+    if (row == last) return;
+    ids_[row] = ids_[last];
+    channels_[row] = channels_[last];
+    types_[row] = types_[last];
+    connected_[row] = connected_[last];
+}
+
+int DeviceTable::countType(ConnectionType type) const {
+    int count = 0;
+    for (int i = 0; i < count_; ++i) count += (types_[i] == type);
+    return count;
+}
+
+int DeviceTable::countConnected() const {
+    int count = 0;
+    for (int i = 0; i < count_; ++i) count += connected_[i];
+    return count;
+}
+
+void DeviceTable::setAllConnected(bool connected) {
+    for (int i = 0; i < count_; ++i) connected_[i] = connected;
+}
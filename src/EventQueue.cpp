@@ -0,0 +1,54 @@
+/* EventQueue.cpp
+ * Implementation of EventQueue.
+ */
+
+#include "../include/EventQueue.h"
+
+EventQueue::EventQueue(int expectedEvents)
+    : size_(0), capacity_(expectedEvents > 16 ? expectedEvents : 16), nextSequence_(0) {
+    heap_ = new Event[capacity_];
+}
+
+EventQueue::~EventQueue() {
+    delete[] heap_;
+}
+
+void EventQueue::grow() {
+    Event* grown = new Event[capacity_ * 2];
+    for (int i = 0; i < size_; ++i) grown[i] = heap_[i];
+    delete[] heap_;
+    heap_ = grown;
+    capacity_ *= 2;
+}
+
+void EventQueue::push(long long time, int target) {
+    if (size_ == capacity_) grow();
+
+    Event event = { time, nextSequence_++, target };
+    int pos = size_++;
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!earlier(event, heap_[parent])) break;
+        heap_[pos] = heap_[parent];
+        pos = parent;
+    }
+    heap_[pos] = event;
+}
+
+Event EventQueue::pop() {
+    Event result = heap_[0];
+    Event last = heap_[--size_];
+
+    // Sift the former last element down from the root, moving the hole instead of swapping.
+    int pos = 0;
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= size_) break;
+        if (child + 1 < size_ && earlier(heap_[child + 1], heap_[child])) child++;
+        if (!earlier(heap_[child], last)) break;
+        heap_[pos] = heap_[child];
+        pos = child;
+    }
+    if (size_ > 0) heap_[pos] = last;
+    return result;
+}
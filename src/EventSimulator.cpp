@@ -0,0 +1,241 @@
+/* EventSimulator.cpp
+ * Implementation of EventSimulator.
+ */
+
+#include "../include/EventSimulator.h"
+#include "../include/Clock.h"
+#include "../include/basicIO.h"
+
+#include <cmath> // for std::log
+
+// Event targets pack (tower << 2) | (voice << 1) | kind; the class bit is only
+// set on departures, so completions can be counted per class.
+static const int ARRIVAL = 0;
+static const int DEPARTURE = 1;
+static const int VOICE_BIT = 2;
+
+EventSimulator::EventSimulator(CellTower* const* towers, int towerCount, const EventConfig& config)
+    : towerCount_(towerCount < 0 ? 0 : towerCount), config_(config),
+      events_(1024), rng_(config.seed ? config.seed : 1) {
+    towers_ = new TowerState[towerCount_ > 0 ? towerCount_ : 1];
+
+    for (int i = 0; i < towerCount_; ++i) {
+        const CellTower* tower = towers[i];
+        const CommunicationProtocol* protocol = tower->getProtocol();
+        TowerState& t = towers_[i];
+
+        t.channels = tower->getChannelCount();
+        t.busy = 0;
+        t.arrivalsPerNs = config_.arrivalRate * tower->getDeviceCount() / 1e9;
+
+        double serviceRate = config_.serviceRate;
+        if (serviceRate <= 0) {
+            serviceRate = static_cast<double>(protocol->getUsersPerChannel()) * protocol->getMessagesPerUser();
+        }
+        t.serviceNs = serviceRate > 0 ? static_cast<long long>(1e9 / serviceRate) : 0;
+        if (t.serviceNs < 1) t.serviceNs = 1;
+
+        t.qos = config_.qos ? *config_.qos : protocol->getQosPolicy();
+        if (t.qos.voiceWeight < 1) t.qos.voiceWeight = 1;
+        if (t.qos.dataWeight < 1) t.qos.dataWeight = 1;
+        // 1/weight scaled by both weights keeps the tags integral.
+        t.tagCost[VOICE] = t.qos.dataWeight;
+        t.tagCost[DATA] = t.qos.voiceWeight;
+        t.virtualTime = 0;
+
+        t.queueLimit = config_.queueLimit > 0 ? config_.queueLimit : tower->getCapacity();
+        for (int c = 0; c < 2; ++c) {
+            t.queue[c] = new Waiting[t.queueLimit > 0 ? t.queueLimit : 1];
+            t.queueHead[c] = 0;
+            t.queueSize[c] = 0;
+            t.lastTag[c] = 0;
+        }
+        t.stats.capacityNs = static_cast<long long>(t.channels) * config_.durationNs;
+        t.stats.simulatedNs = config_.durationNs;
+    }
+}
+
+EventSimulator::~EventSimulator() {
+    for (int i = 0; i < towerCount_; ++i) {
+        delete[] towers_[i].queue[DATA];
+        delete[] towers_[i].queue[VOICE];
+    }
+    delete[] towers_;
+}
+
+// xorshift64*: fast, and the same seed always gives the same run.
+double EventSimulator::nextUniform() {
+    rng_ ^= rng_ >> 12;
+    rng_ ^= rng_ << 25;
+    rng_ ^= rng_ >> 27;
+    unsigned long long bits = (rng_ * 2685821657736338717ULL) >> 11;
+    return (static_cast<double>(bits) + 0.5) * (1.0 / 9007199254740992.0); // (0, 1)
+}
+
+long long EventSimulator::nextGap(double ratePerNs) {
+    long long gap = static_cast<long long>(-std::log(nextUniform()) / ratePerNs);
+    return gap > 0 ? gap : 1;
+}
+
+void EventSimulator::startService(TowerState& t, long long now, long long arrivalNs, bool isVoice) {
+    (isVoice ? t.stats.voiceWait : t.stats.dataWait).record(now - arrivalNs);
+    long long end = now + t.serviceNs;
+    long long horizon = config_.durationNs;
+    t.stats.busyNs += (end < horizon ? end : horizon) - now;
+    int index = static_cast<int>(&t - towers_);
+    events_.push(end, (index << 2) | (isVoice ? VOICE_BIT : 0) | DEPARTURE);
+}
+
+int EventSimulator::pickClass(const TowerState& t) const {
+    if (t.queueSize[VOICE] == 0) return DATA;
+    if (t.queueSize[DATA] == 0) return VOICE;
+
+    const Waiting& voice = t.queue[VOICE][t.queueHead[VOICE]];
+    const Waiting& data = t.queue[DATA][t.queueHead[DATA]];
+    switch (t.qos.discipline) {
+    case QueueDiscipline::STRICT_PRIORITY:
+        return VOICE;
+    case QueueDiscipline::WEIGHTED_FAIR:
+        return voice.tag <= data.tag ? VOICE : DATA;
+    default:
+        return voice.arrivalNs <= data.arrivalNs ? VOICE : DATA;
+    }
+}
+
+void EventSimulator::arrive(int tower, long long now) {
+    TowerState& t = towers_[tower];
+    bool isVoice = nextUniform() < config_.voiceFraction;
+    int c = isVoice ? VOICE : DATA;
+    t.stats.arrivals++;
+    if (isVoice) t.stats.voiceArrivals++;
+
+    long long tag = (t.virtualTime > t.lastTag[c] ? t.virtualTime : t.lastTag[c]) + t.tagCost[c];
+
+    if (t.busy < t.channels) {
+        t.busy++;
+        t.lastTag[c] = tag;
+        t.virtualTime = tag;
+        startService(t, now, now, isVoice);
+    } else if (t.queueSize[c] < t.queueLimit) {
+        int slot = t.queueHead[c] + t.queueSize[c];
+        if (slot >= t.queueLimit) slot -= t.queueLimit;
+        t.queue[c][slot].arrivalNs = now;
+        t.queue[c][slot].tag = tag;
+        t.queueSize[c]++;
+        t.lastTag[c] = tag;
+    } else {
+        t.stats.dropped++;
+        if (isVoice) t.stats.voiceDropped++;
+    }
+
+    long long next = now + nextGap(t.arrivalsPerNs);
+    if (next < config_.durationNs) events_.push(next, (tower << 2) | ARRIVAL);
+}
+
+void EventSimulator::depart(int tower, bool wasVoice, long long now) {
+    TowerState& t = towers_[tower];
+    t.stats.served++;
+    if (wasVoice) t.stats.voiceServed++;
+
+    if (t.queueSize[VOICE] + t.queueSize[DATA] > 0) {
+        int c = pickClass(t);
+        const Waiting& next = t.queue[c][t.queueHead[c]];
+        long long arrivalNs = next.arrivalNs;
+        t.virtualTime = next.tag;
+        t.queueHead[c] = (t.queueHead[c] + 1 == t.queueLimit) ? 0 : t.queueHead[c] + 1;
+        t.queueSize[c]--;
+        startService(t, now, arrivalNs, c == VOICE);
+    } else {
+        t.busy--;
+    }
+}
+
+void EventSimulator::run() {
+    long long wallStart = Clock::nowNanoseconds();
+
+    for (int i = 0; i < towerCount_; ++i) {
+        if (towers_[i].arrivalsPerNs > 0 && towers_[i].channels > 0) {
+            long long first = nextGap(towers_[i].arrivalsPerNs);
+            if (first < config_.durationNs) events_.push(first, (i << 2) | ARRIVAL);
+        }
+    }
+
+    while (!events_.empty() && events_.top().time <= config_.durationNs) {
+        Event e = events_.pop();
+        int tower = e.target >> 2;
+        if ((e.target & 1) == ARRIVAL) {
+            arrive(tower, e.time);
+        } else {
+            depart(tower, (e.target & VOICE_BIT) != 0, e.time);
+        }
+        towers_[tower].stats.events++;
+    }
+
+    total_ = EventStats();
+    for (int i = 0; i < towerCount_; ++i) {
+        TowerState& t = towers_[i];
+        t.stats.backlog = t.queueSize[VOICE] + t.queueSize[DATA] + t.busy;
+        EventStats& s = t.stats;
+        total_.events += s.events;
+        total_.arrivals += s.arrivals;
+        total_.voiceArrivals += s.voiceArrivals;
+        total_.served += s.served;
+        total_.voiceServed += s.voiceServed;
+        total_.dropped += s.dropped;
+        total_.voiceDropped += s.voiceDropped;
+        total_.backlog += s.backlog;
+        total_.busyNs += s.busyNs;
+        total_.capacityNs += s.capacityNs;
+        total_.simulatedNs = s.simulatedNs;
+        total_.voiceWait.merge(s.voiceWait);
+        total_.dataWait.merge(s.dataWait);
+    }
+    total_.wallNs = Clock::nowNanoseconds() - wallStart;
+}
+
+static void printClass(const char* label, long long arrivals, long long served, long long dropped,
+                       long long simulatedNs, const LatencyHistogram& wait) {
+    io.outputstring(label);
+    io.outputstring(": arrivals "); io.outputlong(arrivals);
+    io.outputstring(", served "); io.outputlong(served);
+    io.outputstring(" ("); io.outputlong(Clock::ratePerSecond(served, simulatedNs));
+    io.outputstring("/s), dropped "); io.outputlong(dropped);
+    io.terminate();
+    io.outputstring("  queueing delay (us): mean "); io.outputlong(wait.getMean() / 1000);
+    io.outputstring(", p50 "); io.outputlong(wait.percentile(500) / 1000);
+    io.outputstring(", p99 "); io.outputlong(wait.percentile(990) / 1000);
+    io.outputstring(", p99.9 "); io.outputlong(wait.percentile(999) / 1000);
+    io.outputstring(", max "); io.outputlong(wait.getMax() / 1000);
+    io.terminate();
+}
+
+void EventSimulator::printReport() const {
+    io.outputstring("\n========== Event-Driven Simulation ==========\n"); io.terminate();
+    io.outputstring("Simulated time (ms): "); io.outputlong(config_.durationNs / 1000000); io.terminate();
+    for (int i = 0; i < towerCount_; ++i) {
+        const TowerState& t = towers_[i];
+        io.outputstring("[Tower "); io.outputint(i);
+        io.outputstring("] channels: "); io.outputint(t.channels);
+        io.outputstring(", service time (us): "); io.outputlong(t.serviceNs / 1000);
+        io.outputstring(", scheduler: "); io.outputstring(disciplineName(t.qos.discipline));
+        if (t.qos.discipline == QueueDiscipline::WEIGHTED_FAIR) {
+            io.outputstring(" "); io.outputint(t.qos.voiceWeight);
+            io.outputstring(":"); io.outputint(t.qos.dataWeight);
+        }
+        io.outputstring(", arrivals: "); io.outputlong(t.stats.arrivals);
+        io.outputstring(", served: "); io.outputlong(t.stats.served);
+        io.outputstring(", dropped: "); io.outputlong(t.stats.dropped);
+        io.outputstring(", utilization: "); io.outputint(t.stats.utilizationPermille() / 10);
+        io.outputstring("%"); io.terminate();
+    }
+    printClass("Voice", total_.voiceArrivals, total_.voiceServed, total_.voiceDropped,
+               total_.simulatedNs, total_.voiceWait);
+    printClass("Data", total_.arrivals - total_.voiceArrivals, total_.served - total_.voiceServed,
+               total_.dropped - total_.voiceDropped, total_.simulatedNs, total_.dataWait);
+    io.outputstring("Backlog at end: "); io.outputlong(total_.backlog); io.terminate();
+    io.outputstring("Channel utilization: "); io.outputint(total_.utilizationPermille() / 10);
+    io.outputstring("."); io.outputint(total_.utilizationPermille() % 10); io.outputstring("%"); io.terminate();
+    io.outputstring("Events: "); io.outputlong(total_.events);
+    io.outputstring(" ("); io.outputlong(Clock::ratePerSecond(total_.events, total_.wallNs));
+    io.outputstring(" events/sec)"); io.terminate();
+}
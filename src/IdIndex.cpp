@@ -0,0 +1,108 @@
+/* IdIndex.cpp
+ * Implementation of IdIndex.
+ */
+
+#include "../include/IdIndex.h"
+
+IdIndex::IdIndex(int expectedEntries) : keys_(nullptr), values_(nullptr), size_(0) {
+    int capacity = 16;
+    while (capacity < 2 * expectedEntries && capacity < (1 << 30)) capacity <<= 1;
+    allocate(capacity);
+}
+
+IdIndex::~IdIndex() {
+    delete[] keys_;
+    delete[] values_;
+}
+
+void IdIndex::allocate(int capacity) {
+    capacity_ = capacity;
+    shift_ = 32;
+    for (int c = capacity; c > 1; c >>= 1) shift_--;
+    keys_ = new int[capacity_];
+    values_ = new int[capacity_];
+    for (int i = 0; i < capacity_; ++i) values_[i] = -1;
+}
+
+void IdIndex::grow() {
+    int* oldKeys = keys_;
+    int* oldValues = values_;
+    int oldCapacity = capacity_;
+
+    allocate(capacity_ * 2);
+    for (int i = 0; i < oldCapacity; ++i) {
+        if (oldValues[i] < 0) continue;
+        int b = bucketOf(oldKeys[i]);
+        while (values_[b] >= 0) b = (b + 1) & (capacity_ - 1);
+        keys_[b] = oldKeys[i];
+        values_[b] = oldValues[i];
+    }
+    delete[] oldKeys;
+    delete[] oldValues;
+}
+
+int IdIndex::find(int key) const {
+    int mask = capacity_ - 1;
+    for (int b = bucketOf(key); values_[b] >= 0; b = (b + 1) & mask) {
+        if (keys_[b] == key) return values_[b];
+    }
+    return -1;
+}
+
+bool IdIndex::insert(int key, int value) {
+    if (value < 0) return false;
+    if (2 * (size_ + 1) > capacity_) grow();
+
+    int mask = capacity_ - 1;
+    int b = bucketOf(key);
+    for (; values_[b] >= 0; b = (b + 1) & mask) {
+        if (keys_[b] == key) return false;
+    }
+    keys_[b] = key;
+    values_[b] = value;
+    size_++;
+    return true;
+}
+
+bool IdIndex::update(int key, int value) {
+    if (value < 0) return false;
+    int mask = capacity_ - 1;
+    for (int b = bucketOf(key); values_[b] >= 0; b = (b + 1) & mask) {
+        if (keys_[b] == key) {
+            values_[b] = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IdIndex::erase(int key) {
+    int mask = capacity_ - 1;
+    int b = bucketOf(key);
+    while (true) {
+        if (values_[b] < 0) return false;
+        if (keys_[b] == key) break;
+        b = (b + 1) & mask;
+    }
+
+    // Backward-shift: pull later entries of the probe run into the hole.
+    int hole = b;
+    int next = (hole + 1) & mask;
+    while (values_[next] >= 0) {
+        int home = bucketOf(keys_[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            keys_[hole] = keys_[next];
+            values_[hole] = values_[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    values_[hole] = -1;
+    size_--;
+    return true;
+}
+
+void IdIndex::clear() {
+    for (int i = 0; i < capacity_; ++i) values_[i] = -1;
+    size_ = 0;
+}
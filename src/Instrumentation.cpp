@@ -0,0 +1,151 @@
+/* Instrumentation.cpp
+ * Implementation of Ticks, LatencyHistogram and CoreInstrumentation.
+ */
+
+#include "../include/Instrumentation.h"
+#include "../include/Clock.h"
+#include "../include/basicIO.h"
+
+static double calibrateTicks() {
+    // Spin ~2 ms and compare the tick counter with the monotonic clock.
+    long long startNs = Clock::nowNanoseconds();
+    unsigned long long startTicks = Ticks::now();
+    long long endNs = startNs;
+    while (endNs - startNs < 2000000) endNs = Clock::nowNanoseconds();
+    unsigned long long ticks = Ticks::now() - startTicks;
+    return ticks > 0 ? static_cast<double>(endNs - startNs) / static_cast<double>(ticks) : 1.0;
+}
+
+double Ticks::nanosecondsPerTick() {
+    static const double ratio = calibrateTicks();
+    return ratio;
+}
+
+void LatencyHistogram::reset() {
+    for (int b = 0; b < BUCKETS; ++b) counts_[b] = 0;
+    count_ = 0;
+    sumNs_ = 0;
+    minNs_ = 0;
+    maxNs_ = 0;
+}
+
+void LatencyHistogram::record(long long ns) {
+    if (ns < 0) ns = 0;
+    int bucket = ns == 0 ? 0 : 64 - __builtin_clzll(static_cast<unsigned long long>(ns));
+    if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+    counts_[bucket]++;
+    if (count_ == 0 || ns < minNs_) minNs_ = ns;
+    if (ns > maxNs_) maxNs_ = ns;
+    count_++;
+    sumNs_ += ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.count_ == 0) return;
+    for (int b = 0; b < BUCKETS; ++b) counts_[b] += other.counts_[b];
+    if (count_ == 0 || other.minNs_ < minNs_) minNs_ = other.minNs_;
+    if (other.maxNs_ > maxNs_) maxNs_ = other.maxNs_;
+    count_ += other.count_;
+    sumNs_ += other.sumNs_;
+}
+
+long long LatencyHistogram::percentile(int permille) const {
+    if (count_ == 0) return 0;
+    long long rank = (count_ * permille + 999) / 1000;
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += counts_[b];
+        if (seen >= rank) {
+            long long limit = bucketLimit(b);
+            return limit < maxNs_ ? limit : maxNs_;
+        }
+    }
+    return maxNs_;
+}
+
+CoreInstrumentation::CoreInstrumentation(int towerSlots)
+    : towerSlots_(towerSlots > 0 ? towerSlots : 1) {
+    towerMessages_ = new long long[towerSlots_ + 1];
+    towerFailures_ = new long long[towerSlots_ + 1];
+    reset();
+}
+
+CoreInstrumentation::~CoreInstrumentation() {
+    delete[] towerMessages_;
+    delete[] towerFailures_;
+}
+
+void CoreInstrumentation::reset() {
+    for (int p = 0; p < PHASES; ++p) phases_[p] = PhaseTimer{0, 0, 0};
+    voice_.reset();
+    data_.reset();
+    for (int t = 0; t <= towerSlots_; ++t) {
+        towerMessages_[t] = 0;
+        towerFailures_[t] = 0;
+    }
+}
+
+long long CoreInstrumentation::getPhaseNanoseconds(Phase phase) const {
+    return Ticks::toNanoseconds(phases_[static_cast<int>(phase)].ticks);
+}
+
+static void dumpPrefix(int coreId) {
+    io.outputstring("instr core="); io.outputint(coreId);
+}
+
+static void dumpHistogram(int coreId, const char* label, const LatencyHistogram& histogram) {
+    dumpPrefix(coreId);
+    io.outputstring(" class="); io.outputstring(label);
+    io.outputstring(" count="); io.outputlong(histogram.getCount());
+    io.outputstring(" min_ns="); io.outputlong(histogram.getMin());
+    io.outputstring(" mean_ns="); io.outputlong(histogram.getMean());
+    io.outputstring(" p50_ns="); io.outputlong(histogram.percentile(500));
+    io.outputstring(" p90_ns="); io.outputlong(histogram.percentile(900));
+    io.outputstring(" p99_ns="); io.outputlong(histogram.percentile(990));
+    io.outputstring(" p999_ns="); io.outputlong(histogram.percentile(999));
+    io.outputstring(" max_ns="); io.outputlong(histogram.getMax());
+    io.terminate();
+
+    for (int b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+        if (histogram.getBucketCount(b) == 0) continue;
+        dumpPrefix(coreId);
+        io.outputstring(" class="); io.outputstring(label);
+        io.outputstring(" bucket_lt_ns="); io.outputlong(LatencyHistogram::bucketLimit(b));
+        io.outputstring(" count="); io.outputlong(histogram.getBucketCount(b));
+        io.terminate();
+    }
+}
+
+void CoreInstrumentation::dump(int coreId, const int* towerIds, int towerCount) const {
+    static const char* const PHASE_NAMES[PHASES] = { "generation", "routing", "tower_lookup" };
+
+    for (int p = 0; p < PHASES; ++p) {
+        long long ns = getPhaseNanoseconds(static_cast<Phase>(p));
+        dumpPrefix(coreId);
+        io.outputstring(" phase="); io.outputstring(PHASE_NAMES[p]);
+        io.outputstring(" calls="); io.outputlong(phases_[p].calls);
+        io.outputstring(" items="); io.outputlong(phases_[p].items);
+        io.outputstring(" total_us="); io.outputlong(ns / 1000);
+        io.outputstring(" ns_per_item="); io.outputlong(phases_[p].items > 0 ? ns / phases_[p].items : 0);
+        io.terminate();
+    }
+
+    dumpHistogram(coreId, "voice", voice_);
+    dumpHistogram(coreId, "data", data_);
+
+    if (towerCount > towerSlots_) towerCount = towerSlots_;
+    for (int t = 0; t < towerCount; ++t) {
+        dumpPrefix(coreId);
+        io.outputstring(" tower="); io.outputint(towerIds[t]);
+        io.outputstring(" messages="); io.outputlong(towerMessages_[t]);
+        io.outputstring(" failures="); io.outputlong(towerFailures_[t]);
+        io.terminate();
+    }
+    if (towerMessages_[towerSlots_] > 0) {
+        dumpPrefix(coreId);
+        io.outputstring(" tower=unknown messages="); io.outputlong(towerMessages_[towerSlots_]);
+        io.outputstring(" failures="); io.outputlong(towerFailures_[towerSlots_]);
+        io.terminate();
+    }
+}
@@ -0,0 +1,121 @@
+/* PayloadTable.cpp
+ * Implementation of PayloadTable.
+ */
+
+#include "../include/PayloadTable.h"
+
+PayloadTable::PayloadTable()
+    : arenaSize_(0), arenaCapacity_(1024), count_(0), entryCapacity_(32), bucketCapacity_(64) {
+    arena_ = new char[arenaCapacity_];
+    offsets_ = new int[entryCapacity_];
+    lengths_ = new int[entryCapacity_];
+    buckets_ = new int[bucketCapacity_];
+    for (int i = 0; i < bucketCapacity_; ++i) buckets_[i] = -1;
+    intern("");
+}
+
+PayloadTable::~PayloadTable() {
+    delete[] arena_;
+    delete[] offsets_;
+    delete[] lengths_;
+    delete[] buckets_;
+}
+
+unsigned int PayloadTable::hash(const char* text, int len) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(text[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool PayloadTable::equals(int id, const char* text, int len) const {
+    if (lengths_[id] != len) return false;
+    const char* stored = arena_ + offsets_[id];
+    for (int i = 0; i < len; ++i) {
+        if (stored[i] != text[i]) return false;
+    }
+    return true;
+}
+
+void PayloadTable::growEntries() {
+    int newCapacity = entryCapacity_ * 2;
+    int* offsets = new int[newCapacity];
+    int* lengths = new int[newCapacity];
+    for (int i = 0; i < count_; ++i) {
+        offsets[i] = offsets_[i];
+        lengths[i] = lengths_[i];
+    }
+    delete[] offsets_;
+    delete[] lengths_;
+    offsets_ = offsets;
+    lengths_ = lengths;
+    entryCapacity_ = newCapacity;
+}
+
+void PayloadTable::growBuckets() {
+    delete[] buckets_;
+    bucketCapacity_ *= 2;
+    buckets_ = new int[bucketCapacity_];
+    for (int i = 0; i < bucketCapacity_; ++i) buckets_[i] = -1;
+
+    int mask = bucketCapacity_ - 1;
+    for (int id = 0; id < count_; ++id) {
+        int b = static_cast<int>(hash(arena_ + offsets_[id], lengths_[id]) & mask);
+        while (buckets_[b] >= 0) b = (b + 1) & mask;
+        buckets_[b] = id;
+    }
+}
+
+int PayloadTable::intern(const char* text) {
+    if (!text) text = "";
+    int len = 0;
+    while (len < MAX_PAYLOAD_LENGTH && text[len] != '\0') ++len;
+
+    int mask = bucketCapacity_ - 1;
+    int b = static_cast<int>(hash(text, len) & mask);
+    for (; buckets_[b] >= 0; b = (b + 1) & mask) {
+        if (equals(buckets_[b], text, len)) return buckets_[b];
+    }
+
+    if (count_ >= MAX_PAYLOADS) return -1;
+    if (count_ == entryCapacity_) growEntries();
+
+    if (arenaSize_ + len + 1 > arenaCapacity_) {
+        int newCapacity = arenaCapacity_ * 2;
+        while (arenaSize_ + len + 1 > newCapacity) newCapacity *= 2;
+        char* grown = new char[newCapacity];
+        for (int i = 0; i < arenaSize_; ++i) grown[i] = arena_[i];
+        delete[] arena_;
+        arena_ = grown;
+        arenaCapacity_ = newCapacity;
+    }
+
+    int id = count_++;
+    offsets_[id] = arenaSize_;
+    lengths_[id] = len;
+    for (int i = 0; i < len; ++i) arena_[arenaSize_ + i] = text[i];
+    arena_[arenaSize_ + len] = '\0';
+    arenaSize_ += len + 1;
+    buckets_[b] = id;
+
+    if (2 * count_ > bucketCapacity_) growBuckets();
+    return id;
+}
+
+const char* PayloadTable::get(int id) const {
+    if (id < 0 || id >= count_) return "";
+    return arena_ + offsets_[id];
+}
+
+int PayloadTable::getLength(int id) const {
+    if (id < 0 || id >= count_) return 0;
+    return lengths_[id];
+}
+
+long long PayloadTable::getMemoryUsage() const {
+    return static_cast<long long>(arenaCapacity_)
+         + static_cast<long long>(entryCapacity_) * 2 * sizeof(int)
+         + static_cast<long long>(bucketCapacity_) * sizeof(int);
+}
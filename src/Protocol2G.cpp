@@ -9,7 +9,7 @@ const char* Protocol2G::getName() const {
 }
 
 int Protocol2G::getUsersPerChannel() const {
-    return USERS_PER_200KHZ;
+    return USERS_PER_CHANNEL;
 }
 
 int Protocol2G::getChannelBandwidth() const {
@@ -17,17 +17,20 @@ int Protocol2G::getChannelBandwidth() const {
 }
 
 int Protocol2G::getChannelCount() const {
-    return TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
+    return CHANNEL_COUNT;
 }
 
 int Protocol2G::getFrequencyChannel(int index) const {
-    if (index < 0 || index >= getChannelCount()) return -1;
+    if (index < 0 || index >= CHANNEL_COUNT) return -1;
     return index * CHANNEL_BANDWIDTH_KHZ;
 }
 
+int Protocol2G::getMessagesPerUser() const {
+    return MESSAGES_PER_USER;
+}
+
 int Protocol2G::calculateMaxUsers() const {
-    int channels = TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
-    return channels * USERS_PER_200KHZ;
+    return MAX_USERS;
 }
 
 int Protocol2G::calculateOverhead(int totalMessages) const {
@@ -35,3 +38,11 @@ int Protocol2G::calculateOverhead(int totalMessages) const {
     int overhead = static_cast<int>((totalMessages * OVERHEAD_PERCENT) / 100.0);
     return overhead;
 }
+
+QosPolicy Protocol2G::getQosPolicy() const {
+    QosPolicy policy;
+    policy.discipline = QOS_DISCIPLINE;
+    policy.voiceWeight = QOS_VOICE_WEIGHT;
+    policy.dataWeight = QOS_DATA_WEIGHT;
+    return policy;
+}
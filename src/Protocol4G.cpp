@@ -9,7 +9,7 @@ const char* Protocol4G::getName() const {
 }
 
 int Protocol4G::getUsersPerChannel() const {
-    return USERS_PER_10KHZ * ANTENNAS;
+    return USERS_PER_CHANNEL;
 }
 
 int Protocol4G::getChannelBandwidth() const {
@@ -17,17 +17,20 @@ int Protocol4G::getChannelBandwidth() const {
 }
 
 int Protocol4G::getChannelCount() const {
-    return TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
+    return CHANNEL_COUNT;
 }
 
 int Protocol4G::getFrequencyChannel(int index) const {
-    if (index < 0 || index >= getChannelCount()) return -1;
+    if (index < 0 || index >= CHANNEL_COUNT) return -1;
     return index * CHANNEL_BANDWIDTH_KHZ;
 }
 
+int Protocol4G::getMessagesPerUser() const {
+    return MESSAGES_PER_USER;
+}
+
 int Protocol4G::calculateMaxUsers() const {
-    int channels = TOTAL_SPECTRUM_KHZ / CHANNEL_BANDWIDTH_KHZ;
-    return channels * USERS_PER_10KHZ * ANTENNAS;
+    return MAX_USERS;
 }
 
 int Protocol4G::calculateOverhead(int totalMessages) const {
@@ -37,7 +40,13 @@ int Protocol4G::calculateOverhead(int totalMessages) const {
 }
 
 int Protocol4G::calculateRequiredCores() const {
-    int maxUsers = calculateMaxUsers();
-    int cores = (maxUsers + USERS_PER_CORE - 1) / USERS_PER_CORE;
-    return cores;
+    return REQUIRED_CORES;
+}
+
+QosPolicy Protocol4G::getQosPolicy() const {
+    QosPolicy policy;
+    policy.discipline = QOS_DISCIPLINE;
+    policy.voiceWeight = QOS_VOICE_WEIGHT;
+    policy.dataWeight = QOS_DATA_WEIGHT;
+    return policy;
 }
@@ -0,0 +1,215 @@
+/* ResultWriter.cpp
+ * Implementation of ResultWriter.
+ */
+
+#include "../include/ResultWriter.h"
+#include "../include/basicIO.h"
+
+#define SYS_WRITE 1
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define STDOUT 1
+#define O_WRONLY 01
+#define O_CREAT 0100
+#define O_TRUNC 01000
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+static void writeAll(int fd, const char* data, long len) {
+    while (len > 0) {
+        long written = syscall3(SYS_WRITE, fd, (long)data, len);
+        if (written <= 0) return;
+        data += written;
+        len -= written;
+    }
+}
+
+static int textLength(const char* text) {
+    int len = 0;
+    while (text[len]) len++;
+    return len;
+}
+
+ResultWriter::ResultWriter(ResultFormat format)
+    : format_(format), fd_(STDOUT), ownsFd_(false), length_(0),
+      lineLength_(0), headerLength_(0), headerDone_(false), tableRecord_(false), fields_(0) {
+    table_[0] = '\0';
+}
+
+ResultWriter::~ResultWriter() {
+    flush();
+    if (ownsFd_) syscall3(SYS_CLOSE, fd_, 0, 0);
+}
+
+bool ResultWriter::open(const char* path) {
+    long fd = syscall3(SYS_OPEN, (long)path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    flush();
+    if (ownsFd_) syscall3(SYS_CLOSE, fd_, 0, 0);
+    fd_ = static_cast<int>(fd);
+    ownsFd_ = true;
+    return true;
+}
+
+// Bounded copy into a line buffer; the last byte is kept for the newline.
+void ResultWriter::put(char* target, int& length, const char* text, int size) {
+    for (int i = 0; i < size && length < LINE_SIZE - 1; ++i) target[length++] = text[i];
+}
+
+void ResultWriter::put(char* target, int& length, const char* text) {
+    put(target, length, text, textLength(text));
+}
+
+void ResultWriter::putQuoted(char* target, int& length, const char* text) {
+    static const char HEX[] = "0123456789abcdef";
+    if (format_ == ResultFormat::JSON_LINES) {
+        put(target, length, "\"", 1);
+        for (const char* c = text; *c; ++c) {
+            unsigned char ch = static_cast<unsigned char>(*c);
+            if (ch == '"' || ch == '\\') {
+                char escaped[2] = { '\\', *c };
+                put(target, length, escaped, 2);
+            } else if (ch < 0x20) {
+                char escaped[6] = { '\\', 'u', '0', '0', HEX[ch >> 4], HEX[ch & 15] };
+                put(target, length, escaped, 6);
+            } else {
+                put(target, length, c, 1);
+            }
+        }
+        put(target, length, "\"", 1);
+        return;
+    }
+
+    bool quote = false;
+    for (const char* c = text; *c; ++c) {
+        if (*c == ',' || *c == '"' || *c == '\n' || *c == '\r') quote = true;
+    }
+    if (format_ != ResultFormat::CSV || !quote) {
+        put(target, length, text);
+        return;
+    }
+    put(target, length, "\"", 1);
+    for (const char* c = text; *c; ++c) {
+        put(target, length, c, 1);
+        if (*c == '"') put(target, length, c, 1);
+    }
+    put(target, length, "\"", 1);
+}
+
+void ResultWriter::beginRecord(const char* kind) {
+    lineLength_ = 0;
+    fields_ = 0;
+    tableRecord_ = false;
+
+    switch (format_) {
+    case ResultFormat::CSV: {
+        if (table_[0] == '\0') {
+            int len = 0;
+            while (kind[len] && len < static_cast<int>(sizeof(table_)) - 1) {
+                table_[len] = kind[len];
+                len++;
+            }
+            table_[len] = '\0';
+        }
+        int i = 0;
+        while (kind[i] && kind[i] == table_[i]) i++;
+        tableRecord_ = kind[i] == table_[i];
+        if (!tableRecord_) put(line_, lineLength_, kind); // side record, key=value on stderr
+        break;
+    }
+    case ResultFormat::JSON_LINES:
+        put(line_, lineLength_, "{\"record\":");
+        putQuoted(line_, lineLength_, kind);
+        break;
+    default:
+        put(line_, lineLength_, kind);
+        break;
+    }
+}
+
+void ResultWriter::beginField(const char* key) {
+    if (format_ == ResultFormat::CSV && tableRecord_) {
+        if (fields_ > 0) put(line_, lineLength_, ",", 1);
+        if (!headerDone_) {
+            if (fields_ > 0) put(header_, headerLength_, ",", 1);
+            put(header_, headerLength_, key);
+        }
+    } else if (format_ == ResultFormat::JSON_LINES) {
+        put(line_, lineLength_, ",", 1);
+        putQuoted(line_, lineLength_, key);
+        put(line_, lineLength_, ":", 1);
+    } else {
+        put(line_, lineLength_, " ", 1);
+        put(line_, lineLength_, key);
+        put(line_, lineLength_, "=", 1);
+    }
+    fields_++;
+}
+
+void ResultWriter::field(const char* key, long long value) {
+    beginField(key);
+    char digits[24];
+    int pos = sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do {
+        digits[--pos] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[--pos] = '-';
+    put(line_, lineLength_, digits + pos, static_cast<int>(sizeof(digits)) - pos);
+}
+
+void ResultWriter::field(const char* key, double value) {
+    if (!(value > -9e15 && value < 9e15)) value = 0; // NaN and huge values have no fixed-point form
+    bool negative = value < 0;
+    long long hundredths = static_cast<long long>((negative ? -value : value) * 100 + 0.5);
+    char digits[32];
+    int pos = sizeof(digits);
+    digits[--pos] = static_cast<char>('0' + hundredths % 10);
+    digits[--pos] = static_cast<char>('0' + hundredths / 10 % 10);
+    digits[--pos] = '.';
+    long long whole = hundredths / 100;
+    do {
+        digits[--pos] = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    if (negative && hundredths > 0) digits[--pos] = '-';
+    beginField(key);
+    put(line_, lineLength_, digits + pos, static_cast<int>(sizeof(digits)) - pos);
+}
+
+void ResultWriter::field(const char* key, const char* value) {
+    beginField(key);
+    putQuoted(line_, lineLength_, value);
+}
+
+void ResultWriter::endRecord() {
+    if (format_ == ResultFormat::JSON_LINES) put(line_, lineLength_, "}", 1);
+    line_[lineLength_++] = '\n';
+
+    if (format_ == ResultFormat::CSV && !tableRecord_) {
+        flush();
+        writeAll(2, line_, lineLength_);
+        return;
+    }
+    if (format_ == ResultFormat::CSV && !headerDone_) {
+        header_[headerLength_++] = '\n';
+        append(header_, headerLength_);
+        headerDone_ = true;
+    }
+    append(line_, lineLength_);
+}
+
+void ResultWriter::append(const char* data, int size) {
+    if (length_ + size > BUFFER_SIZE) flush();
+    for (int i = 0; i < size; ++i) buffer_[length_ + i] = data[i];
+    length_ += size;
+}
+
+void ResultWriter::flush() {
+    if (length_ == 0) return;
+    if (fd_ == STDOUT) io.flush();
+    writeAll(fd_, buffer_, length_);
+    length_ = 0;
+}
@@ -0,0 +1,778 @@
+/* Scenario.cpp
+ * Implementation of batch scenario parsing and execution.
+ */
+
+#include "../include/Scenario.h"
+#include "../include/Clock.h"
+#include "../include/ResultWriter.h"
+#include "../include/ThreadPool.h"
+#include "../include/basicIO.h"
+
+#include <cstdio> // for FILE*, fopen, fgets, fclose
+
+static bool sameText(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+static bool parseLong(const char* text, long long& value) {
+    int i = 0;
+    bool neg = false;
+    if (text[i] == '-') {
+        neg = true;
+        i++;
+    }
+    if (text[i] < '0' || text[i] > '9') return false;
+    long long result = 0;
+    for (; text[i] >= '0' && text[i] <= '9'; ++i) {
+        result = result * 10 + (text[i] - '0');
+    }
+    if (text[i] != '\0') return false;
+    value = neg ? -result : result;
+    return true;
+}
+
+static bool parseInt(const char* text, int& value) {
+    long long wide = 0;
+    if (!parseLong(text, wide) || wide < -2147483647LL || wide > 2147483647LL) return false;
+    value = static_cast<int>(wide);
+    return true;
+}
+
+// Non-negative decimal such as "2", "0.5" or "12.75".
+static bool parseDecimal(const char* text, double& value) {
+    int i = 0;
+    double result = 0;
+    bool digits = false;
+    for (; text[i] >= '0' && text[i] <= '9'; ++i) {
+        result = result * 10 + (text[i] - '0');
+        digits = true;
+    }
+    if (text[i] == '.') {
+        double scale = 0.1;
+        for (++i; text[i] >= '0' && text[i] <= '9'; ++i) {
+            result += (text[i] - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if (!digits || text[i] != '\0') return false;
+    value = result;
+    return true;
+}
+
+static bool invalidOption(const char* key, const char* value) {
+    io.errorstring("Error: Invalid value for ");
+    io.errorstring(key);
+    io.errorstring(": ");
+    io.errorstring(value);
+    io.errorstring("\n");
+    return false;
+}
+
+static const char* protocolKey(int choice) {
+    switch (choice) {
+    case 1: return "2G";
+    case 2: return "3G";
+    case 3: return "4G";
+    case 4: return "5G";
+    case 5: return "custom";
+    default: return "unknown";
+    }
+}
+
+// Menu number for a protocol name, or 0.
+static int protocolChoiceOf(const char* value) {
+    if (sameText(value, "2g") || sameText(value, "2G") || sameText(value, "1")) return 1;
+    if (sameText(value, "3g") || sameText(value, "3G") || sameText(value, "2")) return 2;
+    if (sameText(value, "4g") || sameText(value, "4G") || sameText(value, "3")) return 3;
+    if (sameText(value, "5g") || sameText(value, "5G") || sameText(value, "4")) return 4;
+    if (sameText(value, "custom") || sameText(value, "5")) return 5;
+    return 0;
+}
+
+// Copies a non-empty path that fits in ScenarioOptions::MAX_PATH.
+static bool copyPath(const char* value, char* path) {
+    int len = 0;
+    while (value[len] && len < ScenarioOptions::MAX_PATH - 1) {
+        path[len] = value[len];
+        len++;
+    }
+    if (value[len] != '\0' || len == 0) return false;
+    path[len] = '\0';
+    return true;
+}
+
+// Copies the next comma-separated item of text into item; returns the rest, or nullptr at the end.
+static const char* nextItem(const char* text, char* item, int size) {
+    int len = 0;
+    while (text && *text && *text != ',') {
+        if (len < size - 1) item[len++] = *text;
+        ++text;
+    }
+    item[len] = '\0';
+    return text && *text == ',' ? text + 1 : nullptr;
+}
+
+// "5,10,20:40:10" -> 5 10 20 30 40
+static bool parseAxis(const char* value, SweepAxis& axis) {
+    axis.count = 0;
+    const char* rest = value;
+    do {
+        char item[64];
+        rest = nextItem(rest, item, sizeof(item));
+
+        // Split first:last:step in place.
+        char* parts[3] = { item, nullptr, nullptr };
+        int partCount = 1;
+        for (char* c = item; *c; ++c) {
+            if (*c == ':') {
+                if (partCount == 3) return false;
+                *c = '\0';
+                parts[partCount++] = c + 1;
+            }
+        }
+        long long first = 0;
+        long long last = 0;
+        long long step = 1;
+        if (!parseLong(parts[0], first)) return false;
+        last = first;
+        if (partCount > 1 && !parseLong(parts[1], last)) return false;
+        if (partCount > 2 && (!parseLong(parts[2], step) || step <= 0)) return false;
+        if (last < first) return false;
+
+        for (long long v = first; v <= last; v += step) {
+            if (axis.count == SweepAxis::MAX_VALUES) return false;
+            axis.values[axis.count++] = v;
+        }
+    } while (rest);
+    return axis.count > 0;
+}
+
+bool applyScenarioOption(const char* key, const char* value, ScenarioOptions& options) {
+    SimulationConfig& config = options.config;
+    SweepOptions& sweep = options.sweep;
+
+    if (sameText(key, "protocol")) {
+        config.protocolChoice = protocolChoiceOf(value);
+        return config.protocolChoice != 0 || invalidOption(key, value);
+    }
+    if (sameText(key, "sweep-protocols")) {
+        sweep.protocolCount = 0;
+        const char* rest = value;
+        do {
+            char item[16];
+            rest = nextItem(rest, item, sizeof(item));
+            int choice = protocolChoiceOf(item);
+            if (choice == 0 || sweep.protocolCount == 5) return invalidOption(key, value);
+            sweep.protocols[sweep.protocolCount++] = choice;
+        } while (rest);
+        sweep.enabled = true;
+        return true;
+    }
+    if (sameText(key, "sweep-overhead") || sameText(key, "sweep-messages") ||
+        sameText(key, "sweep-users-per-channel") || sameText(key, "sweep-channel-bandwidth") ||
+        sameText(key, "sweep-total-spectrum")) {
+        SweepAxis& axis = sameText(key, "sweep-overhead") ? sweep.overhead
+                        : sameText(key, "sweep-messages") ? sweep.messages
+                        : sameText(key, "sweep-users-per-channel") ? sweep.usersPerChannel
+                        : sameText(key, "sweep-channel-bandwidth") ? sweep.channelBandwidth
+                        : sweep.totalSpectrum;
+        if (!parseAxis(value, axis)) return invalidOption(key, value);
+        sweep.enabled = true;
+        return true;
+    }
+    if (sameText(key, "jobs")) {
+        if (!parseInt(value, sweep.jobs) || sweep.jobs < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "users-per-channel")) {
+        return parseInt(value, config.usersPerChannel) || invalidOption(key, value);
+    }
+    if (sameText(key, "channel-bandwidth")) {
+        return parseInt(value, config.channelBandwidth) || invalidOption(key, value);
+    }
+    if (sameText(key, "total-spectrum")) {
+        return parseInt(value, config.totalSpectrum) || invalidOption(key, value);
+    }
+    if (sameText(key, "messages")) {
+        if (!parseLong(value, config.totalMessages) || config.totalMessages < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "overhead")) {
+        return parseInt(value, config.overheadPercent) || invalidOption(key, value);
+    }
+    if (sameText(key, "devices")) {
+        if (sameText(value, "synthetic")) {
+            options.deviceFile[0] = '\0';
+            return true;
+        }
+        return copyPath(value, options.deviceFile) || invalidOption(key, value);
+    }
+    if (sameText(key, "load-snapshot")) {
+        return copyPath(value, options.snapshotLoad) || invalidOption(key, value);
+    }
+    if (sameText(key, "save-snapshot")) {
+        return copyPath(value, options.snapshotSave) || invalidOption(key, value);
+    }
+    if (sameText(key, "format")) {
+        if (sameText(value, "text")) options.format = ResultFormat::KEY_VALUE;
+        else if (sameText(value, "csv")) options.format = ResultFormat::CSV;
+        else if (sameText(value, "jsonl")) options.format = ResultFormat::JSON_LINES;
+        else return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "output")) {
+        return copyPath(value, options.outputFile) || invalidOption(key, value);
+    }
+    if (sameText(key, "repeat")) {
+        if (!parseInt(value, options.repetitions) || options.repetitions < 1) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "threads")) {
+        if (!parseInt(value, config.threads) || config.threads < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "balancing")) {
+        if (sameText(value, "round-robin")) config.balancing = static_cast<int>(BalancingPolicy::ROUND_ROBIN);
+        else if (sameText(value, "least-loaded")) config.balancing = static_cast<int>(BalancingPolicy::LEAST_LOADED);
+        else if (sameText(value, "hashed")) config.balancing = static_cast<int>(BalancingPolicy::HASHED);
+        else return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "duration-ms")) {
+        if (!parseLong(value, config.durationMs) || config.durationMs < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "arrival-rate")) {
+        if (!parseDecimal(value, config.arrivalRate) || config.arrivalRate <= 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "service-rate")) {
+        return parseDecimal(value, config.serviceRate) || invalidOption(key, value);
+    }
+    if (sameText(key, "queue-limit")) {
+        if (!parseInt(value, config.queueLimit) || config.queueLimit < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "voice-rate")) {
+        return parseDecimal(value, config.voiceRate) || invalidOption(key, value);
+    }
+    if (sameText(key, "data-rate")) {
+        return parseDecimal(value, config.dataRate) || invalidOption(key, value);
+    }
+    if (sameText(key, "scheduler")) {
+        if (sameText(value, "protocol")) config.qosDiscipline = -1;
+        else if (sameText(value, "fifo")) config.qosDiscipline = static_cast<int>(QueueDiscipline::FIFO);
+        else if (sameText(value, "priority")) config.qosDiscipline = static_cast<int>(QueueDiscipline::STRICT_PRIORITY);
+        else if (sameText(value, "wfq")) config.qosDiscipline = static_cast<int>(QueueDiscipline::WEIGHTED_FAIR);
+        else return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "voice-weight")) {
+        if (!parseInt(value, config.voiceWeight) || config.voiceWeight < 1) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "data-weight")) {
+        if (!parseInt(value, config.dataWeight) || config.dataWeight < 1) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "traffic-mix")) {
+        // "V:D", e.g. 3:1; "protocol" restores the protocol's own mix.
+        if (sameText(value, "protocol")) {
+            config.mixVoice = 0;
+            config.mixData = 0;
+            return true;
+        }
+        char voice[16];
+        int len = 0;
+        while (value[len] && value[len] != ':' && len < 15) {
+            voice[len] = value[len];
+            len++;
+        }
+        voice[len] = '\0';
+        if (value[len] != ':' || !parseInt(voice, config.mixVoice) || !parseInt(value + len + 1, config.mixData)
+            || config.mixVoice < 0 || config.mixData < 0 || config.mixVoice + config.mixData < 1
+            || config.mixVoice > 1000000 || config.mixData > 1000000) {
+            return invalidOption(key, value);
+        }
+        return true;
+    }
+    if (sameText(key, "towers")) {
+        if (!parseInt(value, config.topology.towerCount) || config.topology.towerCount < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "mobile-devices")) {
+        if (!parseInt(value, config.topology.deviceCount) || config.topology.deviceCount < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "layout")) {
+        if (sameText(value, "grid")) config.topology.layout = TowerLayout::GRID;
+        else if (sameText(value, "random")) config.topology.layout = TowerLayout::RANDOM;
+        else return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "spacing")) {
+        if (!parseDecimal(value, config.topology.spacingM) || config.topology.spacingM <= 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "min-speed")) {
+        return parseDecimal(value, config.topology.minSpeed) || invalidOption(key, value);
+    }
+    if (sameText(key, "max-speed")) {
+        return parseDecimal(value, config.topology.maxSpeed) || invalidOption(key, value);
+    }
+    if (sameText(key, "step-ms")) {
+        if (!parseLong(value, config.topology.stepMs) || config.topology.stepMs < 1) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "hysteresis")) {
+        return parseDecimal(value, config.topology.hysteresisM) || invalidOption(key, value);
+    }
+    if (sameText(key, "tower-index")) {
+        if (sameText(value, "grid")) config.topology.spatialIndex = true;
+        else if (sameText(value, "scan")) config.topology.spatialIndex = false;
+        else return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "tower-capacity")) {
+        if (!parseInt(value, config.topology.towerCapacity) || config.topology.towerCapacity < 0) return invalidOption(key, value);
+        return true;
+    }
+    if (sameText(key, "scenario")) {
+        return loadScenarioFile(value, options);
+    }
+
+    io.errorstring("Error: Unknown option: ");
+    io.errorstring(key);
+    io.errorstring("\n");
+    return false;
+}
+
+bool loadScenarioFile(const char* path, ScenarioOptions& options) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) {
+        io.errorstring("Error: Could not open scenario file: ");
+        io.errorstring(path);
+        io.errorstring("\n");
+        return false;
+    }
+
+    char line[512];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && std::fgets(line, sizeof(line), f)) {
+        lineNumber++;
+
+        // Strip comment and trailing whitespace, split on the first '='.
+        int end = 0;
+        while (line[end] && line[end] != '#' && line[end] != '\n' && line[end] != '\r') end++;
+        while (end > 0 && (line[end - 1] == ' ' || line[end - 1] == '\t')) end--;
+        line[end] = '\0';
+
+        int start = 0;
+        while (line[start] == ' ' || line[start] == '\t') start++;
+        if (line[start] == '\0') continue;
+
+        int eq = start;
+        while (line[eq] && line[eq] != '=') eq++;
+        if (line[eq] != '=') {
+            io.errorstring("Error: Expected key=value at ");
+            io.errorstring(path);
+            io.errorstring(":");
+            io.errorint(lineNumber);
+            io.errorstring("\n");
+            ok = false;
+            break;
+        }
+
+        int keyEnd = eq;
+        while (keyEnd > start && (line[keyEnd - 1] == ' ' || line[keyEnd - 1] == '\t')) keyEnd--;
+        line[keyEnd] = '\0';
+        int valueStart = eq + 1;
+        while (line[valueStart] == ' ' || line[valueStart] == '\t') valueStart++;
+
+        // "scenario" is command line only; a file naming itself would never end.
+        if (sameText(line + start, "scenario")) {
+            io.errorstring("Error: scenario cannot be used inside a scenario file at ");
+            io.errorstring(path);
+            io.errorstring(":");
+            io.errorint(lineNumber);
+            io.errorstring("\n");
+            ok = false;
+            break;
+        }
+
+        ok = applyScenarioOption(line + start, line + valueStart, options);
+    }
+
+    std::fclose(f);
+    return ok;
+}
+
+bool parseScenarioArguments(int argc, char** argv, ScenarioOptions& options) {
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (arg[0] != '-' || arg[1] != '-') {
+            io.errorstring("Error: Expected --option, got: ");
+            io.errorstring(arg);
+            io.errorstring("\n");
+            return false;
+        }
+
+        char key[64];
+        int len = 0;
+        const char* p = arg + 2;
+        while (*p && *p != '=' && len < 63) key[len++] = *p++;
+        key[len] = '\0';
+
+        const char* value;
+        if (*p == '=') {
+            value = p + 1;
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            io.errorstring("Error: Missing value for --");
+            io.errorstring(key);
+            io.errorstring("\n");
+            return false;
+        }
+
+        if (!applyScenarioOption(key, value, options)) return false;
+    }
+
+    if (options.config.protocolChoice == 0 && options.sweep.protocolCount == 0) {
+        io.errorstring("Error: --protocol (or --sweep-protocols) is required in batch mode\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Which optional column groups the result records of a scenario carry. They are
+ * decided once per scenario so that every record has the same columns (CSV).
+ */
+struct ResultColumns {
+    bool sweep;        ///< point, overhead_pct
+    bool custom;       ///< custom protocol parameters
+    bool topology;
+    bool eventDriven;
+};
+
+static ResultColumns columnsOf(const ScenarioOptions& options) {
+    const SimulationConfig& config = options.config;
+    const SweepOptions& sweep = options.sweep;
+    ResultColumns columns;
+    columns.sweep = sweep.enabled;
+    columns.custom = sweep.enabled && config.protocolChoice == 5 && sweep.protocolCount == 0;
+    for (int p = 0; p < sweep.protocolCount; ++p) {
+        if (sweep.protocols[p] == 5) columns.custom = true;
+    }
+    columns.topology = config.topology.towerCount > 0;
+    columns.eventDriven = !columns.topology && config.durationMs > 0;
+    return columns;
+}
+
+static void writeResult(ResultWriter& out, const ResultColumns& columns, int run, long long point,
+                        bool ok, const SimulationConfig& config, const SimulationResult& r) {
+    out.beginRecord("result");
+    out.field("run", run);
+    if (columns.sweep) out.field("point", point);
+    out.field("status", ok ? "ok" : "error");
+    out.field("protocol", protocolKey(config.protocolChoice));
+    if (columns.sweep) out.field("overhead_pct", config.overheadPercent);
+    if (columns.custom) {
+        out.field("users_per_channel", config.usersPerChannel);
+        out.field("channel_bandwidth", config.channelBandwidth);
+        out.field("total_spectrum", config.totalSpectrum);
+    }
+    out.field("cores", r.coreCount);
+    out.field("balancing", balancingName(r.balancing));
+    out.field("max_devices", r.maxDevices);
+    out.field("devices", r.devicesAdded);
+    out.field("device_source", r.devicesFromSnapshot ? "snapshot" : r.devicesFromFile ? "file" : "synthetic");
+    out.field("populate_us", r.populateNs / 1000);
+    out.field("messages", r.totalMessages);
+    out.field("voice", r.voiceMessages);
+    out.field("data", r.dataMessages);
+    out.field("overhead", r.overheadMessages);
+    out.field("processed", r.processed);
+    out.field("failed", r.failed);
+    out.field("first_channel_users", r.firstChannelUsers);
+    out.field("channel_capacity", r.maxChannelUsers);
+    out.field("channel_load_min", r.channels.total.min);
+    out.field("channel_load_max", r.channels.total.max);
+    out.field("channel_load_mean", r.channels.total.mean());
+    out.field("channel_load_stddev", r.channels.total.stddev());
+    out.field("channels_full", r.channels.fullChannels);
+    out.field("channels_empty", r.channels.emptyChannels);
+    out.field("voice_load_mean", r.channels.voice.mean());
+    out.field("voice_load_max", r.channels.voice.max);
+    out.field("data_load_mean", r.channels.data.mean());
+    out.field("data_load_max", r.channels.data.max);
+    out.field("elapsed_us", r.elapsedNs / 1000);
+    out.field("messages_per_sec", Clock::ratePerSecond(r.totalMessages, r.elapsedNs));
+    if (columns.topology) {
+        const HandoverStats& h = r.handover;
+        out.field("towers", r.towerCount);
+        out.field("sim_ms", h.simulatedNs / 1000000);
+        out.field("steps", h.steps);
+        out.field("handover_attempts", h.attempts);
+        out.field("handovers", h.handovers);
+        out.field("handover_capacity_failures", h.capacityFailures);
+        out.field("attach_failures", h.attachFailures);
+        out.field("unattached", h.unattached);
+        out.field("mobility_us", h.mobilityNs / 1000);
+        out.field("selection_us", h.selectionNs / 1000);
+        out.field("handover_us", h.handoverNs / 1000);
+        out.field("handovers_per_sec", Clock::ratePerSecond(h.attempts, h.handoverNs));
+    }
+    if (columns.eventDriven) {
+        const EventStats& e = r.events;
+        char weights[24];
+        int len = 0;
+        int parts[2] = { r.qos.voiceWeight, r.qos.dataWeight };
+        for (int k = 0; k < 2; ++k) {
+            char digits[12];
+            int n = 0;
+            int value = parts[k] > 0 ? parts[k] : 0;
+            do {
+                digits[n++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            if (k == 1) weights[len++] = ':';
+            while (n > 0) weights[len++] = digits[--n];
+        }
+        weights[len] = '\0';
+
+        out.field("sim_ms", config.durationMs);
+        out.field("served", e.served);
+        out.field("dropped", e.dropped);
+        out.field("backlog", e.backlog);
+        out.field("scheduler", disciplineName(r.qos.discipline));
+        out.field("weights", weights);
+        out.field("voice_served", e.voiceServed);
+        out.field("voice_dropped", e.voiceDropped);
+        out.field("voice_per_sec", Clock::ratePerSecond(e.voiceServed, e.simulatedNs));
+        out.field("data_per_sec", Clock::ratePerSecond(e.served - e.voiceServed, e.simulatedNs));
+        out.field("voice_wait_p50_us", e.voiceWait.percentile(500) / 1000);
+        out.field("voice_wait_p99_us", e.voiceWait.percentile(990) / 1000);
+        out.field("voice_wait_p999_us", e.voiceWait.percentile(999) / 1000);
+        out.field("data_wait_p50_us", e.dataWait.percentile(500) / 1000);
+        out.field("data_wait_p99_us", e.dataWait.percentile(990) / 1000);
+        out.field("data_wait_p999_us", e.dataWait.percentile(999) / 1000);
+        out.field("utilization_permille", e.utilizationPermille());
+        out.field("events", e.events);
+        out.field("events_per_sec", Clock::ratePerSecond(e.events, e.wallNs));
+    }
+    out.endRecord();
+}
+
+// Records go to options.outputFile when set, otherwise to stdout.
+static bool openOutput(const ScenarioOptions& options, ResultWriter& out) {
+    if (options.outputFile[0] == '\0' || out.open(options.outputFile)) return true;
+    io.errorstring("Error: Cannot open output file: ");
+    io.errorstring(options.outputFile);
+    io.errorstring("\n");
+    return false;
+}
+
+int runScenario(const ScenarioOptions& options) {
+    if (options.sweep.enabled) return runSweep(options);
+
+    ResultWriter out(options.format);
+    if (!openOutput(options, out)) return 1;
+    ResultColumns columns = columnsOf(options);
+
+    SimulationConfig config = options.config;
+    config.deviceFile = options.deviceFile[0] ? options.deviceFile : nullptr;
+    config.snapshotLoad = options.snapshotLoad[0] ? options.snapshotLoad : nullptr;
+    config.snapshotSave = options.snapshotSave[0] ? options.snapshotSave : nullptr;
+
+    int succeeded = 0;
+    long long totalMessages = 0;
+    long long totalNs = 0;
+
+    for (int run = 1; run <= options.repetitions; ++run) {
+        SimulationResult r;
+        bool ok = runSimulation(config, r, false);
+        writeResult(out, columns, run, 0, ok, config, r);
+        out.flush();
+
+        if (ok) succeeded++;
+        totalMessages += r.totalMessages;
+        totalNs += r.elapsedNs;
+    }
+
+    out.beginRecord("summary");
+    out.field("runs", options.repetitions);
+    out.field("ok", succeeded);
+    out.field("messages", totalMessages);
+    out.field("elapsed_us", totalNs / 1000);
+    out.field("messages_per_sec", Clock::ratePerSecond(totalMessages, totalNs));
+    out.endRecord();
+    out.flush();
+
+    return succeeded == options.repetitions ? 0 : 1;
+}
+
+// Axis value i, or the scenario's value when the axis is not swept.
+static long long axisValue(const SweepAxis& axis, int i, long long fallback) {
+    return axis.count > 0 ? axis.values[i] : fallback;
+}
+
+static int axisSize(const SweepAxis& axis) {
+    return axis.count > 0 ? axis.count : 1;
+}
+
+static int sweepProtocol(const SweepOptions& sweep, const SimulationConfig& base, int p) {
+    return sweep.protocolCount > 0 ? sweep.protocols[p] : base.protocolChoice;
+}
+
+/**
+ * The configuration of sweep point `point` (0-based). Points are numbered
+ * protocol by protocol, then by overhead, messages and, for custom protocols,
+ * users per channel, channel bandwidth and total spectrum (fastest).
+ */
+static SimulationConfig sweepConfig(const SweepOptions& sweep, const SimulationConfig& base, long long point) {
+    int common = axisSize(sweep.overhead) * axisSize(sweep.messages);
+    int customPoints = axisSize(sweep.usersPerChannel) * axisSize(sweep.channelBandwidth)
+                     * axisSize(sweep.totalSpectrum);
+
+    int p = 0;
+    int choice = sweepProtocol(sweep, base, 0);
+    long long block = static_cast<long long>(common) * (choice == 5 ? customPoints : 1);
+    while (point >= block) {
+        point -= block;
+        choice = sweepProtocol(sweep, base, ++p);
+        block = static_cast<long long>(common) * (choice == 5 ? customPoints : 1);
+    }
+    int custom = choice == 5 ? customPoints : 1;
+    int c = static_cast<int>(point % custom);
+    int m = static_cast<int>(point / custom % axisSize(sweep.messages));
+    int o = static_cast<int>(point / custom / axisSize(sweep.messages));
+
+    SimulationConfig config = base;
+    config.protocolChoice = choice;
+    config.overheadPercent = static_cast<int>(axisValue(sweep.overhead, o, base.overheadPercent));
+    config.totalMessages = axisValue(sweep.messages, m, base.totalMessages);
+    if (choice == 5) {
+        int spectrum = c % axisSize(sweep.totalSpectrum);
+        int bandwidth = c / axisSize(sweep.totalSpectrum) % axisSize(sweep.channelBandwidth);
+        int users = c / (axisSize(sweep.totalSpectrum) * axisSize(sweep.channelBandwidth));
+        config.usersPerChannel = static_cast<int>(axisValue(sweep.usersPerChannel, users, base.usersPerChannel));
+        config.channelBandwidth = static_cast<int>(axisValue(sweep.channelBandwidth, bandwidth, base.channelBandwidth));
+        config.totalSpectrum = static_cast<int>(axisValue(sweep.totalSpectrum, spectrum, base.totalSpectrum));
+    }
+    return config;
+}
+
+struct SweepJob {
+    const SimulationConfig* configs;
+    SimulationResult* results;
+    bool* ok;
+};
+
+static void runSweepPoint(int index, void* context) {
+    SweepJob* job = static_cast<SweepJob*>(context);
+    job->ok[index] = runSimulation(job->configs[index], job->results[index], false);
+}
+
+int runSweep(const ScenarioOptions& options) {
+    const SweepOptions& sweep = options.sweep;
+    SimulationConfig base = options.config;
+    base.deviceFile = options.deviceFile[0] ? options.deviceFile : nullptr;
+    base.snapshotLoad = options.snapshotLoad[0] ? options.snapshotLoad : nullptr;
+    base.snapshotSave = nullptr;
+    if (options.snapshotSave[0]) {
+        // Concurrent points would all write the same file.
+        io.errorstring("Error: save-snapshot cannot be combined with a sweep\n");
+        return 1;
+    }
+    if (base.threads == 0) base.threads = 1; // parallelism comes from running points side by side
+
+    int protocolCount = sweep.protocolCount > 0 ? sweep.protocolCount : 1;
+    int commonPoints = axisSize(sweep.overhead) * axisSize(sweep.messages);
+    int customPoints = axisSize(sweep.usersPerChannel) * axisSize(sweep.channelBandwidth)
+                     * axisSize(sweep.totalSpectrum);
+
+    long long pointCount = 0;
+    for (int p = 0; p < protocolCount; ++p) {
+        int choice = sweepProtocol(sweep, base, p);
+        pointCount += static_cast<long long>(commonPoints) * (choice == 5 ? customPoints : 1);
+    }
+    const long long MAX_RUNS = 1000000000LL;
+    if (pointCount > MAX_RUNS / options.repetitions) {
+        io.errorstring("Error: Sweep has too many runs (limit 1000000000)\n");
+        return 1;
+    }
+    long long runs = pointCount * options.repetitions;
+
+    ResultWriter out(options.format);
+    if (!openOutput(options, out)) return 1;
+    ResultColumns columns = columnsOf(options);
+
+    int jobs = sweep.jobs > 0 ? sweep.jobs : ThreadPool::hardwareThreads();
+    if (jobs > runs) jobs = runs > 0 ? static_cast<int>(runs) : 1;
+
+    // Runs go through the pool a chunk at a time and their rows are written
+    // out before the next chunk starts, so memory stays flat however long the
+    // sweep is. A few tasks per worker keeps workers busy across uneven runs.
+    int chunk = jobs * 32;
+    if (chunk > runs) chunk = static_cast<int>(runs);
+    SimulationConfig* configs = new SimulationConfig[chunk > 0 ? chunk : 1];
+    SimulationResult* results = new SimulationResult[chunk > 0 ? chunk : 1];
+    bool* ok = new bool[chunk > 0 ? chunk : 1];
+
+    long long succeeded = 0;
+    long long totalMessages = 0;
+    long long totalNs = 0;
+    long long start = Clock::nowNanoseconds();
+    {
+        ThreadPool pool(jobs);
+        SweepJob job = { configs, results, ok };
+        for (long long first = 0; first < runs; first += chunk) {
+            int count = runs - first < chunk ? static_cast<int>(runs - first) : chunk;
+            for (int i = 0; i < count; ++i) {
+                long long point = (first + i) / options.repetitions;
+                if (i == 0 || (first + i) % options.repetitions == 0) {
+                    configs[i] = sweepConfig(sweep, base, point);
+                } else {
+                    configs[i] = configs[i - 1];
+                }
+            }
+            pool.run(count, &runSweepPoint, &job);
+
+            for (int i = 0; i < count; ++i) {
+                long long index = first + i;
+                writeResult(out, columns, static_cast<int>(index % options.repetitions) + 1,
+                            index / options.repetitions + 1, ok[i], configs[i], results[i]);
+                if (ok[i]) succeeded++;
+                totalMessages += results[i].totalMessages;
+                totalNs += results[i].elapsedNs;
+            }
+            out.flush();
+        }
+    }
+    long long wallNs = Clock::nowNanoseconds() - start;
+
+    out.beginRecord("summary");
+    out.field("runs", runs);
+    out.field("points", pointCount);
+    out.field("ok", succeeded);
+    out.field("jobs", jobs);
+    out.field("messages", totalMessages);
+    out.field("elapsed_us", totalNs / 1000);
+    out.field("wall_us", wallNs / 1000);
+    out.field("runs_per_sec", Clock::ratePerSecond(runs, wallNs));
+    out.endRecord();
+    out.flush();
+
+    delete[] configs;
+    delete[] results;
+    delete[] ok;
+    return succeeded == runs ? 0 : 1;
+}
@@ -0,0 +1,487 @@
+/* Simulation.cpp
+ * Implementation of a single simulation run.
+ */
+
+#include "../include/Simulation.h"
+#include "../include/CellTower.h"
+#include "../include/CellularNetwork.h"
+#include "../include/Clock.h"
+#include "../include/CustomProtocol.h"
+#include "../include/DeviceInventory.h"
+#include "../include/EventSimulator.h"
+#include "../include/Protocol2G.h"
+#include "../include/Protocol3G.h"
+#include "../include/Protocol4G.h"
+#include "../include/Protocol5G.h"
+#include "../include/ProtocolTraits.h"
+#include "../include/Topology.h"
+#include "../include/UserDevice.h"
+#include "../include/Utility.h"
+#include "../include/basicIO.h"
+
+// Progress text goes to stdout in verbose runs and to stderr otherwise, so
+// batch output stays machine-readable. Quiet runs must not touch stdout at
+// all: sweep workers run them concurrently, and only the stderr functions
+// leave the shared stdout buffer alone.
+static void notice(bool verbose, const char* text) {
+    if (verbose) {
+        io.outputstring(text);
+    } else {
+        io.errorstring(text);
+    }
+}
+
+static void noticeLine(bool verbose, const char* prefix, long long number, const char* suffix) {
+    if (verbose) {
+        io.outputstring(prefix); io.outputlong(number); io.outputstring(suffix);
+    } else {
+        io.errorstring(prefix); io.errorlong(number); io.errorstring(suffix);
+    }
+}
+
+// Load user devices from a CSV/TXT file.
+// Format per line: deviceId,TypeChar   e.g., 5001,D  or  5002,V
+// Malformed rows are skipped and reported by line number.
+static bool loadDevicesFromFile(const char* filename, CellularNetwork* network, int maxDevices,
+                                int& devicesAdded, int threads, bool verbose) {
+    DeviceInventory inventory;
+    if (!inventory.loadFile(filename, threads)) {
+        notice(verbose, "Error: Could not open user file: ");
+        notice(verbose, filename);
+        notice(verbose, "\n");
+        return false;
+    }
+
+    for (int i = 0; i < inventory.getReportedBadRows(); ++i) {
+        notice(verbose, "Warning: ");
+        notice(verbose, filename);
+        noticeLine(verbose, ":", inventory.getBadRowLine(i), ": malformed row skipped\n");
+    }
+    long long unreported = inventory.getBadRowCount() - inventory.getReportedBadRows();
+    if (unreported > 0) {
+        noticeLine(verbose, "Warning: ", unreported, " more malformed rows skipped\n");
+    }
+
+    // Attach rows until maxDevices (the capacity after overhead) are in. Duplicate
+    // IDs are skipped by the network, so the next batch covers the shortfall.
+    const int* ids = inventory.getIds();
+    const ConnectionType* types = inventory.getTypes();
+    int rows = inventory.getCount();
+    int next = 0;
+    while (devicesAdded < maxDevices && next < rows) {
+        int batch = maxDevices - devicesAdded;
+        if (batch > rows - next) batch = rows - next;
+        devicesAdded += network->addUserDevices(ids + next, types + next, batch);
+        next += batch;
+    }
+
+    if (devicesAdded == 0) {
+        notice(verbose, "Warning: No valid devices loaded from file.\n");
+        return false;
+    }
+
+    return true;
+}
+
+static bool validCustomConfig(const SimulationConfig& config) {
+    if (config.channelBandwidth <= 0 || config.totalSpectrum <= 0 || config.usersPerChannel <= 0) {
+        return false;
+    }
+    return config.channelBandwidth <= config.totalSpectrum;
+}
+
+CommunicationProtocol* createProtocol(const SimulationConfig& config) {
+    switch (config.protocolChoice) {
+    case 1: return new Protocol2G();
+    case 2: return new Protocol3G();
+    case 3: return new Protocol4G();
+    case 4: return new Protocol5G();
+    case 5:
+        if (!validCustomConfig(config)) return nullptr;
+        return new CustomProtocol(config.usersPerChannel, config.channelBandwidth, config.totalSpectrum);
+    default:
+        return nullptr;
+    }
+}
+
+void printProtocolInfo(const CommunicationProtocol* protocol, int protocolChoice) {
+    io.outputstring("\n========== "); io.outputstring(protocol->getName()); io.outputstring(" Protocol Information ==========\n"); io.terminate();
+
+    io.outputstring("Users per channel: "); io.outputint(protocol->getUsersPerChannel()); io.terminate();
+    io.outputstring("Channel bandwidth (kHz): "); io.outputint(protocol->getChannelBandwidth()); io.terminate();
+    io.outputstring("Number of channels: "); io.outputint(protocol->getChannelCount()); io.terminate();
+    io.outputstring("Maximum users supported: "); io.outputint(protocol->calculateMaxUsers()); io.terminate();
+
+    if (protocolChoice == 3 || protocolChoice == 4) {
+         io.outputstring("Required Cellular Cores: "); io.outputint(protocol->calculateRequiredCores()); io.terminate();
+    }
+}
+
+// Hundredths, for loads that are rarely whole numbers.
+static void outputFixed2(double value) {
+    long long hundredths = static_cast<long long>(value * 100 + 0.5);
+    io.outputlong(hundredths / 100);
+    io.outputstring(hundredths % 100 < 10 ? ".0" : ".");
+    io.outputlong(hundredths % 100);
+}
+
+static void printLoad(const char* label, const LoadSummary& load) {
+    io.outputstring(label);
+    io.outputstring("min "); io.outputint(load.min);
+    io.outputstring(", max "); io.outputint(load.max);
+    io.outputstring(", mean "); outputFixed2(load.mean());
+    io.outputstring(", stddev "); outputFixed2(load.stddev());
+    io.terminate();
+}
+
+static void printChannelStats(const ChannelStats& stats) {
+    if (stats.total.channels == 0) return;
+    io.outputstring("  - Channels: "); io.outputint(stats.total.channels);
+    io.outputstring(" ("); io.outputint(stats.emptyChannels); io.outputstring(" empty, ");
+    io.outputint(stats.fullChannels); io.outputstring(" full)"); io.terminate();
+    printLoad("  - Users per channel: ", stats.total);
+    printLoad("      voice: ", stats.voice);
+    printLoad("      data:  ", stats.data);
+    io.outputstring("  - Busiest channel: tower "); io.outputint(stats.busiestTowerId);
+    io.outputstring(", channel "); io.outputint(stats.busiestChannel);
+    io.outputstring(" ("); io.outputint(stats.total.max); io.outputstring(" users)"); io.terminate();
+    io.outputstring("  - Occupancy histogram (channels per 10% band, last = full):");
+    for (int b = 0; b < ChannelStats::HISTOGRAM_BUCKETS; ++b) {
+        io.outputstring(" "); io.outputint(stats.histogram[b]);
+    }
+    io.terminate();
+}
+
+// Mobility run over config.topology.towerCount towers; replaces message traffic.
+template <class P>
+static bool simulateTopology(const P& protocol, const SimulationConfig& config,
+                             int towerBudget, SimulationResult& result, bool verbose) {
+    typedef ProtocolTraits<P> Traits;
+
+    TopologyConfig topologyConfig = config.topology;
+    if (config.durationMs > 0) topologyConfig.durationMs = config.durationMs;
+    // Each tower gets the overhead-reduced budget, or tower-capacity if smaller.
+    if (topologyConfig.towerCapacity <= 0 || topologyConfig.towerCapacity > towerBudget) {
+        topologyConfig.towerCapacity = towerBudget;
+    }
+
+    long long start = Clock::nowNanoseconds();
+    Topology topology(&protocol, topologyConfig, 5001);
+    topology.attachAll();
+    if (verbose) {
+        io.outputstring("\nAttached "); io.outputint(topology.getDeviceCount() - static_cast<int>(topology.getStats().attachFailures));
+        io.outputstring(" of "); io.outputint(topology.getDeviceCount());
+        io.outputstring(" mobile devices to "); io.outputint(topology.getTowerCount());
+        io.outputstring(" towers\n"); io.terminate();
+    }
+    topology.run();
+    if (verbose) topology.printReport();
+
+    result.topologyMode = true;
+    result.towerCount = topology.getTowerCount();
+    // Budget of the whole topology; no fixed message count is generated, so
+    // the message fields stay 0.
+    result.maxDevices = 0;
+    for (int t = 0; t < topology.getTowerCount(); ++t) result.maxDevices += topology.getTower(t)->getCapacity();
+    result.handover = topology.getStats();
+    result.devicesAdded = result.handover.attached;
+    for (int t = 0; t < topology.getTowerCount(); ++t) {
+        result.channels.merge(topology.getTower(t)->getChannelStats());
+    }
+    // First-channel figures come from tower 0, as in the single-site run.
+    int firstChannelFreq = Traits::frequency(protocol, 0);
+    result.firstChannelUsers = topology.getTower(0)->getUsersOnFrequency(firstChannelFreq);
+    result.firstChannelFreq = Traits::bandOffsetKhz(protocol) + firstChannelFreq;
+    result.maxChannelUsers = Traits::usersPerChannel(protocol);
+    result.elapsedNs = Clock::nowNanoseconds() - start;
+    return true;
+}
+
+// One simulation for a concrete protocol type. Protocol queries go through
+// ProtocolTraits, so the built-in protocols resolve them at compile time.
+template <class P>
+static bool simulate(P& protocol, const SimulationConfig& config, SimulationResult& result, bool verbose) {
+    typedef ProtocolTraits<P> Traits;
+
+    int choice = config.protocolChoice;
+    int towerId = choice; // one tower id per protocol, as in the menu
+    long long totalMessages = config.totalMessages > 0 ? config.totalMessages : 0;
+    int overheadPercent = config.overheadPercent;
+
+    if (overheadPercent < 0 || overheadPercent > 100) {
+        if (verbose) {
+            io.outputstring("\nInvalid overhead percentage. Clamping to [0, 100].\n"); io.terminate();
+        }
+        overheadPercent = clampValue<int>(overheadPercent, 0, 100);
+    }
+
+    if constexpr (!Traits::COMPILE_TIME) {
+        protocol.setOverheadPercent(static_cast<double>(overheadPercent));
+    }
+
+    long long overheadMessages = (totalMessages * overheadPercent) / 100;
+
+    TrafficPattern mix;
+    mix.setProtocolMix(Traits::VOICE_CENTRIC);
+    if (config.mixVoice + config.mixData > 0) {
+        mix.voiceShare = config.mixVoice;
+        mix.dataShare = config.mixData;
+    }
+
+    result.protocolName = protocol.getName();
+    bool topologyMode = config.topology.towerCount > 0;
+    if (!topologyMode) {
+        result.totalMessages = totalMessages;
+        result.overheadMessages = overheadMessages;
+    }
+
+    if (verbose && !topologyMode) {
+        io.outputstring("\n========== Overhead Calculation ==========\n"); io.terminate();
+        io.outputstring("Total messages requested: "); io.outputlong(totalMessages); io.terminate();
+        io.outputstring("Overhead percentage: "); io.outputint(overheadPercent); io.outputstring("%\n"); io.terminate();
+        io.outputstring("Overhead reduction: "); io.outputlong(overheadMessages); io.outputstring(" messages reserved for overhead\n"); io.terminate();
+    }
+
+    int maxCapacity = Traits::maxUsers(protocol);
+    int maxDevices = maxCapacity - ((maxCapacity * overheadPercent) / 100);
+
+    if (maxCapacity > 0 && maxDevices < 1) maxDevices = 1;
+
+    if (maxDevices > CellTower::MAX_DEVICES) {
+        if (verbose) {
+            io.outputstring("Note: Limiting devices to tower capacity of ");
+            io.outputint(CellTower::MAX_DEVICES);
+            io.outputstring("\n"); io.terminate();
+        }
+        maxDevices = CellTower::MAX_DEVICES;
+    }
+    result.maxDevices = maxDevices;
+
+    if (verbose) {
+        io.outputstring("Maximum devices after overhead reduction: "); io.outputint(maxDevices); io.terminate();
+    }
+
+    if (maxDevices <= 0) {
+        notice(verbose, "\nError: No devices can be supported with current configuration. Skipping simulation.\n");
+        return false;
+    }
+
+    if (topologyMode) {
+        return simulateTopology(protocol, config, maxDevices, result, verbose);
+    }
+
+    long long start = Clock::nowNanoseconds();
+    bool ok = true;
+    {
+        CellularNetwork network(&protocol, Traits::requiredCores(protocol), towerId,
+                                static_cast<BalancingPolicy>(config.balancing));
+        CellTower* tower = network.getTower(0);
+        result.coreCount = network.getCoreCount();
+        result.balancing = network.getPolicy();
+
+        if (verbose) {
+            io.outputstring("\n========== Device Allocation ==========\n"); io.terminate();
+            if (network.getCoreCount() < Traits::requiredCores(protocol)) {
+                io.outputstring("Note: Limiting network to "); io.outputint(CellularNetwork::MAX_CORES);
+                io.outputstring(" cores\n");
+            }
+            if (network.getCoreCount() > 1) {
+                io.outputstring("Cellular cores instantiated: "); io.outputint(network.getCoreCount()); io.terminate();
+            }
+            io.outputstring("Tower memory usage (bytes): "); io.outputlong(tower->getMemoryUsage()); io.terminate();
+        }
+
+        long long populateStart = Clock::nowNanoseconds();
+        int devicesAdded = 0;
+        if (config.snapshotLoad) {
+            // A saved population replaces both device sources; a snapshot that
+            // does not match this network fails the run rather than mixing.
+            if (!network.loadSnapshot(config.snapshotLoad)) {
+                notice(verbose, "Error: Cannot load snapshot (missing, corrupt or from another configuration): ");
+                notice(verbose, config.snapshotLoad);
+                notice(verbose, "\n");
+                ok = false;
+            } else if (network.getDeviceCount() > maxDevices) {
+                notice(verbose, "Error: Snapshot holds more devices than this run allows\n");
+                ok = false;
+            } else {
+                devicesAdded = network.getDeviceCount();
+                result.devicesFromSnapshot = true;
+                if (verbose) {
+                    io.outputstring("Restored "); io.outputint(devicesAdded);
+                    io.outputstring(" devices from snapshot: "); io.outputstring(config.snapshotLoad);
+                    io.terminate();
+                }
+            }
+        } else if (config.deviceFile) {
+            if (verbose) {
+                io.outputstring("Attempting to load devices from file: ");
+                io.outputstring(config.deviceFile);
+                io.outputstring("\n"); io.terminate();
+            }
+
+            if (loadDevicesFromFile(config.deviceFile, &network, maxDevices, devicesAdded, config.threads, verbose)) {
+                result.devicesFromFile = true;
+            } else {
+                notice(verbose, "Falling back to synthetic device generation.\n");
+                if (verbose) io.terminate();
+            }
+        }
+
+        if (devicesAdded == 0 && !config.snapshotLoad) {
+            if (verbose) {
+                io.outputstring("Adding "); io.outputint(maxDevices); io.outputstring(" devices to tower...\n"); io.terminate();
+            }
+
+            // The quiet batch form: quiet runs may be sweep workers, which must not print.
+            for (int i = 1; i <= maxDevices; ++i) {
+                ConnectionType type = (i % 3 == 0) ? ConnectionType::VOICE : ConnectionType::DATA;
+                int deviceId = 5000 + i;
+                if (network.addUserDevices(&deviceId, &type, 1) == 0) break;
+                devicesAdded++;
+            }
+        }
+        result.devicesAdded = devicesAdded;
+        result.populateNs = Clock::nowNanoseconds() - populateStart;
+
+        if (ok && devicesAdded > 0 && config.snapshotSave) {
+            if (network.saveSnapshot(config.snapshotSave)) {
+                if (verbose) {
+                    io.outputstring("Saved device population to snapshot: "); io.outputstring(config.snapshotSave);
+                    io.terminate();
+                }
+            } else {
+                notice(verbose, "Error: Cannot write snapshot: ");
+                notice(verbose, config.snapshotSave);
+                notice(verbose, "\n");
+                ok = false;
+            }
+        }
+
+        if (ok && devicesAdded == 0) {
+            notice(verbose, "Error: Failed to allocate any devices to tower.\n");
+            if (verbose) io.terminate();
+            ok = false;
+        } else if (ok) {
+            int firstChannelFreq = Traits::frequency(protocol, 0);
+            result.firstChannelUsers = tower->getUsersOnFrequency(firstChannelFreq);
+            result.firstChannelFreq = Traits::bandOffsetKhz(protocol) + firstChannelFreq;
+            result.maxChannelUsers = Traits::usersPerChannel(protocol);
+            for (int i = 0; i < network.getCoreCount(); ++i) {
+                result.channels.merge(network.getTower(i)->getChannelStats());
+            }
+
+            if (verbose) {
+                io.outputstring("\nFirst channel frequency (kHz): "); io.outputint(result.firstChannelFreq); io.terminate();
+                io.outputstring("Users on first channel: "); io.outputint(result.firstChannelUsers); io.terminate();
+            }
+        }
+
+        if (ok && config.durationMs > 0) {
+            // Event-driven model: arrivals and service over simulated time
+            // replace the fixed message count.
+            double voiceShare = static_cast<double>(mix.voiceShare) / (mix.voiceShare + mix.dataShare);
+            EventConfig eventConfig;
+            eventConfig.durationNs = config.durationMs * 1000000;
+            eventConfig.arrivalRate = config.arrivalRate;
+            eventConfig.voiceFraction = voiceShare;
+            // The protocol-derived default, resolved here rather than by virtual calls per tower.
+            eventConfig.serviceRate = config.serviceRate > 0
+                ? config.serviceRate
+                : static_cast<double>(Traits::usersPerChannel(protocol)) * Traits::messagesPerUser(protocol);
+            eventConfig.queueLimit = config.queueLimit;
+
+            // Per-class rates let voice load stay fixed while data load grows.
+            if (config.voiceRate >= 0 || config.dataRate >= 0) {
+                double voiceRate = config.voiceRate >= 0 ? config.voiceRate : config.arrivalRate * voiceShare;
+                double dataRate = config.dataRate >= 0 ? config.dataRate : config.arrivalRate * (1 - voiceShare);
+                eventConfig.arrivalRate = voiceRate + dataRate;
+                eventConfig.voiceFraction = eventConfig.arrivalRate > 0 ? voiceRate / eventConfig.arrivalRate : 0;
+            }
+
+            QosPolicy qos = protocol.getQosPolicy();
+            if (config.qosDiscipline >= 0) qos.discipline = static_cast<QueueDiscipline>(config.qosDiscipline);
+            if (config.voiceWeight > 0) qos.voiceWeight = config.voiceWeight;
+            if (config.dataWeight > 0) qos.dataWeight = config.dataWeight;
+            eventConfig.qos = &qos;
+            result.qos = qos;
+
+            CellTower* towers[CellularNetwork::MAX_CORES];
+            for (int i = 0; i < network.getCoreCount(); ++i) towers[i] = network.getTower(i);
+
+            EventSimulator events(towers, network.getCoreCount(), eventConfig);
+            events.run();
+            if (verbose) events.printReport();
+
+            const EventStats& stats = events.getStats();
+            result.eventDriven = true;
+            result.events = stats;
+            result.totalMessages = stats.arrivals;
+            result.voiceMessages = stats.voiceArrivals;
+            result.dataMessages = stats.arrivals - stats.voiceArrivals;
+            result.processed = stats.served;
+            result.failed = stats.dropped;
+        } else if (ok) {
+            if (verbose) {
+
+                io.outputstring("\n========== Message Generation & Processing ==========\n"); io.terminate();
+                io.outputstring("Generating "); io.outputlong(totalMessages); io.outputstring(" messages...\n"); io.terminate();
+
+                io.outputstring("\nProcessing messages on "); io.outputint(network.getCoreCount()); io.outputstring(" core(s)...\n"); io.terminate();
+            }
+            network.run(totalMessages, mix.voiceShare, mix.dataShare, config.threads);
+            if (verbose) {
+                network.printReport();
+                // Report text only, so batch records stay clean.
+                if (SIM_INSTRUMENTATION_ENABLED) network.dumpInstrumentation();
+            }
+
+            result.processed = network.getTotalProcessed();
+            result.failed = network.getTotalFailed();
+            result.voiceMessages = network.getTotalVoice();
+            result.dataMessages = network.getTotalMessages() - result.voiceMessages;
+        }
+    }
+    result.elapsedNs = Clock::nowNanoseconds() - start;
+
+    if (ok && verbose) {
+        io.outputstring("\n========== Simulation Complete ==========\n"); io.terminate();
+        io.outputstring("Total messages processed: "); io.outputlong(result.totalMessages); io.terminate();
+        io.outputstring("  - Voice messages: "); io.outputlong(result.voiceMessages); io.terminate();
+        io.outputstring("  - Data messages: "); io.outputlong(result.dataMessages); io.terminate();
+
+        io.outputstring("Devices utilized: "); io.outputint(result.devicesAdded);
+        io.outputstring(" of "); io.outputint(maxDevices); io.terminate();
+        io.outputstring("Overhead incurred: "); io.outputlong(overheadMessages); io.outputstring(" messages ("); io.outputint(overheadPercent); io.outputstring("%)\n"); io.terminate();
+
+        io.outputstring("Channel Statistics:\n"); io.terminate();
+        io.outputstring("  - First channel frequency (kHz): "); io.outputint(result.firstChannelFreq); io.terminate();
+        io.outputstring("  - Users on first channel: "); io.outputint(result.firstChannelUsers); io.terminate();
+        io.outputstring("  - Max capacity per channel: "); io.outputint(result.maxChannelUsers); io.terminate();
+        printChannelStats(result.channels);
+    }
+
+    return ok;
+}
+
+bool runSimulation(const SimulationConfig& config, SimulationResult& result, bool verbose) {
+    result = SimulationResult();
+
+    // The only protocol dispatch of a run; everything below it is specialized.
+    switch (config.protocolChoice) {
+    case 1: { Protocol2G protocol; return simulate(protocol, config, result, verbose); }
+    case 2: { Protocol3G protocol; return simulate(protocol, config, result, verbose); }
+    case 3: { Protocol4G protocol; return simulate(protocol, config, result, verbose); }
+    case 4: { Protocol5G protocol; return simulate(protocol, config, result, verbose); }
+    case 5:
+        if (validCustomConfig(config)) {
+            CustomProtocol protocol(config.usersPerChannel, config.channelBandwidth, config.totalSpectrum);
+            return simulate(protocol, config, result, verbose);
+        }
+        break;
+    default:
+        break;
+    }
+    notice(verbose, "\nError: Invalid protocol configuration. Skipping simulation.\n");
+    return false;
+}
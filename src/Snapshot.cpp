@@ -0,0 +1,320 @@
+/* Snapshot.cpp
+ * Implementation of Snapshot.
+ */
+
+#include "../include/Snapshot.h"
+
+#define SYS_WRITE 1
+#define SYS_OPEN 2
+#define SYS_CLOSE 3
+#define SYS_FSTAT 5
+#define SYS_MMAP 9
+#define SYS_MUNMAP 11
+#define SYS_PWRITE64 18
+#define SYS_MADVISE 28
+#define O_RDONLY 0
+#define O_WRONLY 01
+#define O_CREAT 0100
+#define O_TRUNC 01000
+#define PROT_READ 1
+#define MAP_PRIVATE 2
+#define MADV_SEQUENTIAL 2
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+extern "C" long syscall6(long number, long arg1, long arg2, long arg3, long arg4, long arg5, long arg6);
+
+// x86_64 struct stat; only st_size is read.
+struct KernelStat {
+    unsigned long dev;
+    unsigned long ino;
+    unsigned long nlink;
+    unsigned int mode;
+    unsigned int uid;
+    unsigned int gid;
+    unsigned int pad0;
+    unsigned long rdev;
+    long size;
+    long blksize;
+    long blocks;
+    unsigned long times[6];
+    long reserved[3];
+};
+
+static const char MAGIC[8] = { 'C', 'E', 'L', 'L', 'S', 'N', 'A', 'P' };
+static const unsigned int BYTE_ORDER_MARK = 0x01020304u;
+
+struct SnapshotHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int byteOrder;
+    int coreCount;
+    int reserved;
+    long long fileBytes;         ///< patched in once everything is written
+};
+
+struct CoreRecord {
+    int towerCount;
+    int queueSize;
+    int payloadCount;            ///< including the implicit empty payload 0
+    int reserved;
+    long long generated;
+    long long processed;
+    long long failed;
+    long long rejected;
+    long long payloadBytes;      ///< texts of payloads 1..payloadCount-1, before padding
+};
+
+struct TowerRecord {
+    int towerId;
+    int capacity;
+    int channelCount;
+    int usersPerChannel;
+    int deviceCount;
+    int policy;                  ///< AllocationPolicy
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0 && sizeof(CoreRecord) % 8 == 0 && sizeof(TowerRecord) % 8 == 0,
+              "snapshot records must keep sections 8-byte aligned");
+static_assert(sizeof(ConnectionType) == 1 && sizeof(bool) == 1,
+              "device type and connected columns are stored as single bytes");
+
+static long long padded(long long bytes) {
+    return (bytes + 7) & ~7LL;
+}
+
+// Sequential writer with a 64 KB buffer; large columns bypass it.
+class SnapshotWriter {
+public:
+    static constexpr int BUFFER_SIZE = 1 << 16;
+
+private:
+    long fd_;
+    char buffer_[BUFFER_SIZE];
+    int length_;
+    long long offset_;
+    bool failed_;
+
+    void writeOut(const char* data, long long len) {
+        while (len > 0 && !failed_) {
+            long written = syscall3(SYS_WRITE, fd_, (long)data, len);
+            if (written <= 0) {
+                failed_ = true;
+                return;
+            }
+            data += written;
+            len -= written;
+        }
+    }
+
+public:
+    explicit SnapshotWriter(long fd) : fd_(fd), length_(0), offset_(0), failed_(false) {}
+
+    void write(const void* data, long long len) {
+        const char* bytes = static_cast<const char*>(data);
+        offset_ += len;
+        if (len > BUFFER_SIZE / 2) {
+            flush();
+            writeOut(bytes, len);
+            return;
+        }
+        if (length_ + len > BUFFER_SIZE) flush();
+        for (long long i = 0; i < len; ++i) buffer_[length_ + i] = bytes[i];
+        length_ += static_cast<int>(len);
+    }
+
+    void align() {
+        static const char ZEROS[8] = { 0 };
+        write(ZEROS, padded(offset_) - offset_);
+    }
+
+    void flush() {
+        writeOut(buffer_, length_);
+        length_ = 0;
+    }
+
+    long long getOffset() const { return offset_; }
+    bool ok() const { return !failed_; }
+};
+
+bool Snapshot::save(const char* path, const CellularCore* const* cores, int coreCount) {
+    long fd = syscall3(SYS_OPEN, (long)path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    SnapshotWriter* out = new SnapshotWriter(fd);
+    SnapshotHeader header = {};
+    for (int i = 0; i < 8; ++i) header.magic[i] = MAGIC[i];
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.coreCount = coreCount;
+    out->write(&header, sizeof(header));
+
+    for (int c = 0; c < coreCount; ++c) {
+        const CellularCore* core = cores[c];
+
+        CoreRecord record = {};
+        record.towerCount = core->getTowerCount();
+        record.queueSize = core->getQueueSize();
+        record.payloadCount = core->getPayloadCount();
+        record.generated = core->getTotalMessagesGenerated();
+        record.processed = core->getTotalMessagesProcessed();
+        record.failed = core->getTotalMessagesFailed();
+        record.rejected = core->getTotalMessagesRejected();
+        for (int p = 1; p < record.payloadCount; ++p) {
+            const char* text = core->getPayloadText(p);
+            int len = 0;
+            while (text[len]) len++;
+            record.payloadBytes += len + 1;
+        }
+        out->write(&record, sizeof(record));
+
+        for (int p = 1; p < record.payloadCount; ++p) {
+            const char* text = core->getPayloadText(p);
+            int len = 0;
+            while (text[len]) len++;
+            out->write(text, len + 1);
+        }
+        out->align();
+
+        // The ring may wrap, so messages are written oldest first one by one.
+        for (int i = 0; i < record.queueSize; ++i) {
+            out->write(&core->getQueuedMessage(i), sizeof(Message));
+        }
+
+        for (int t = 0; t < record.towerCount; ++t) {
+            const CellTower* tower = core->getTowerAt(t);
+            const DeviceTable& table = tower->getDeviceTable();
+            const CommunicationProtocol* protocol = tower->getProtocol();
+
+            TowerRecord towerRecord = {};
+            towerRecord.towerId = tower->getTowerId();
+            towerRecord.capacity = tower->getCapacity();
+            towerRecord.channelCount = tower->getChannelCount();
+            towerRecord.usersPerChannel = protocol ? protocol->getUsersPerChannel() : 0;
+            towerRecord.deviceCount = table.getCount();
+            towerRecord.policy = static_cast<int>(tower->getAllocationPolicy());
+            out->write(&towerRecord, sizeof(towerRecord));
+
+            long long n = table.getCount();
+            out->write(table.ids(), n * sizeof(int));
+            out->align();
+            out->write(table.channels(), n * sizeof(int));
+            out->align();
+            out->write(table.types(), n);
+            out->align();
+            out->write(table.connected(), n);
+            out->align();
+        }
+    }
+    out->flush();
+
+    header.fileBytes = out->getOffset();
+    bool ok = out->ok()
+           && syscall6(SYS_PWRITE64, fd, (long)&header, sizeof(header), 0, 0, 0) == (long)sizeof(header);
+    delete out;
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    return ok;
+}
+
+// Bounds-checked walk over the mapped file; every section starts 8-byte aligned.
+struct SnapshotReader {
+    const char* data;
+    long long size;
+    long long offset;
+
+    const void* take(long long bytes) {
+        if (bytes < 0 || offset + bytes > size) return nullptr;
+        const void* p = data + offset;
+        offset = padded(offset + bytes);
+        return p;
+    }
+};
+
+static bool validBytes(const unsigned char* bytes, int count) {
+    unsigned char bad = 0;
+    for (int i = 0; i < count; ++i) bad |= bytes[i];
+    return (bad & ~1u) == 0; // 0/1 only: DATA/VOICE, false/true
+}
+
+static bool loadCore(SnapshotReader& in, CellularCore* core) {
+    const CoreRecord* record = static_cast<const CoreRecord*>(in.take(sizeof(CoreRecord)));
+    if (!record || record->towerCount != core->getTowerCount() || core->getQueueSize() != 0) return false;
+    if (record->payloadCount < 1 || record->payloadBytes < 0) return false;
+
+    const char* texts = static_cast<const char*>(in.take(record->payloadBytes));
+    if (!texts) return false;
+    long long pos = 0;
+    for (int p = 1; p < record->payloadCount; ++p) {
+        long long end = pos;
+        while (end < record->payloadBytes && texts[end] != '\0') end++;
+        if (end == record->payloadBytes) return false;
+        if (core->internPayload(texts + pos) != p) return false;
+        pos = end + 1;
+    }
+
+    if (record->queueSize < 0) return false;
+    const Message* messages = static_cast<const Message*>(
+        in.take(static_cast<long long>(record->queueSize) * sizeof(Message)));
+    if (!messages || !core->restoreQueue(messages, record->queueSize, record->generated,
+                                         record->processed, record->failed, record->rejected)) {
+        return false;
+    }
+
+    for (int t = 0; t < record->towerCount; ++t) {
+        const TowerRecord* towerRecord = static_cast<const TowerRecord*>(in.take(sizeof(TowerRecord)));
+        if (!towerRecord) return false;
+        CellTower* tower = core->getCellTower(towerRecord->towerId);
+        const CommunicationProtocol* protocol = tower ? tower->getProtocol() : nullptr;
+        if (!tower || tower->getCapacity() != towerRecord->capacity
+            || tower->getChannelCount() != towerRecord->channelCount
+            || (protocol ? protocol->getUsersPerChannel() : 0) != towerRecord->usersPerChannel) {
+            return false;
+        }
+
+        int n = towerRecord->deviceCount;
+        if (n < 0 || n > towerRecord->capacity) return false;
+        const int* ids = static_cast<const int*>(in.take(static_cast<long long>(n) * sizeof(int)));
+        const int* channels = static_cast<const int*>(in.take(static_cast<long long>(n) * sizeof(int)));
+        const unsigned char* types = static_cast<const unsigned char*>(in.take(n));
+        const unsigned char* connected = static_cast<const unsigned char*>(in.take(n));
+        if (!ids || !channels || !types || !connected) return false;
+        if (!validBytes(types, n) || !validBytes(connected, n)) return false;
+
+        if (!tower->restoreDevices(ids, channels, reinterpret_cast<const ConnectionType*>(types),
+                                   reinterpret_cast<const bool*>(connected), n)) {
+            return false;
+        }
+        tower->setAllocationPolicy(towerRecord->policy == static_cast<int>(AllocationPolicy::LEAST_LOADED)
+                                       ? AllocationPolicy::LEAST_LOADED : AllocationPolicy::FIRST_FIT);
+    }
+    return true;
+}
+
+bool Snapshot::load(const char* path, CellularCore* const* cores, int coreCount) {
+    long fd = syscall3(SYS_OPEN, (long)path, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    KernelStat st;
+    if (syscall3(SYS_FSTAT, fd, (long)&st, 0) < 0 || st.size < static_cast<long>(sizeof(SnapshotHeader))) {
+        syscall3(SYS_CLOSE, fd, 0, 0);
+        return false;
+    }
+    long long size = st.size;
+    long mapped = syscall6(SYS_MMAP, 0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    syscall3(SYS_CLOSE, fd, 0, 0);
+    if (mapped < 0 && mapped > -4096) return false;
+    syscall3(SYS_MADVISE, mapped, size, MADV_SEQUENTIAL);
+
+    SnapshotReader in = { reinterpret_cast<const char*>(mapped), size, 0 };
+    const SnapshotHeader* header = static_cast<const SnapshotHeader*>(in.take(sizeof(SnapshotHeader)));
+    bool ok = true;
+    for (int i = 0; i < 8; ++i) ok = ok && header->magic[i] == MAGIC[i];
+    ok = ok && header->version == VERSION && header->byteOrder == BYTE_ORDER_MARK
+            && header->fileBytes == size && header->coreCount == coreCount;
+
+    for (int c = 0; ok && c < coreCount; ++c) {
+        ok = loadCore(in, cores[c]);
+    }
+
+    syscall3(SYS_MUNMAP, mapped, size, 0);
+    return ok;
+}
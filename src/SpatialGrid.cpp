@@ -0,0 +1,178 @@
+/* SpatialGrid.cpp
+ * Implementation of SpatialGrid.
+ */
+
+#include "../include/SpatialGrid.h"
+
+#include <cmath> // for std::sqrt
+
+SpatialGrid::SpatialGrid()
+    : count_(0), minX_(0), minY_(0), cellSize_(1), inverseCellSize_(1),
+      columns_(0), rows_(0),
+      cellStart_(nullptr), cellPoints_(nullptr), cellX_(nullptr), cellY_(nullptr) {}
+
+SpatialGrid::~SpatialGrid() {
+    delete[] cellStart_;
+    delete[] cellPoints_;
+    delete[] cellX_;
+    delete[] cellY_;
+}
+
+void SpatialGrid::build(const double* xs, const double* ys, int count,
+                        double minX, double minY, double maxX, double maxY) {
+    delete[] cellStart_;
+    delete[] cellPoints_;
+    delete[] cellX_;
+    delete[] cellY_;
+    cellStart_ = nullptr;
+    cellPoints_ = nullptr;
+    cellX_ = nullptr;
+    cellY_ = nullptr;
+    count_ = count > 0 ? count : 0;
+    columns_ = 0;
+    rows_ = 0;
+    if (count_ == 0) return;
+
+    for (int i = 0; i < count_; ++i) {
+        if (xs[i] < minX) minX = xs[i];
+        if (xs[i] > maxX) maxX = xs[i];
+        if (ys[i] < minY) minY = ys[i];
+        if (ys[i] > maxY) maxY = ys[i];
+    }
+    double width = maxX - minX;
+    double height = maxY - minY;
+
+    // About two points per cell (measured faster than one: fewer empty cells to
+    // visit per ring); a degenerate region falls back to a single row.
+    double area = width * height;
+    cellSize_ = area > 0 ? std::sqrt(2 * area / count_) : (width > height ? width : height) / count_;
+    if (!(cellSize_ > 0)) cellSize_ = 1.0;
+    inverseCellSize_ = 1.0 / cellSize_;
+    minX_ = minX;
+    minY_ = minY;
+    columns_ = static_cast<int>(width * inverseCellSize_) + 1;
+    rows_ = static_cast<int>(height * inverseCellSize_) + 1;
+
+    int cells = columns_ * rows_;
+    cellStart_ = new int[cells + 1];
+    cellPoints_ = new int[count_];
+    cellX_ = new double[count_];
+    cellY_ = new double[count_];
+    for (int c = 0; c <= cells; ++c) cellStart_[c] = 0;
+
+    // Counting sort by cell: count, prefix-sum, scatter.
+    for (int i = 0; i < count_; ++i) {
+        cellStart_[clampRow(ys[i]) * columns_ + clampColumn(xs[i]) + 1]++;
+    }
+    for (int c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+    int* cursor = new int[cells];
+    for (int c = 0; c < cells; ++c) cursor[c] = cellStart_[c];
+    for (int i = 0; i < count_; ++i) {
+        int slot = cursor[clampRow(ys[i]) * columns_ + clampColumn(xs[i])]++;
+        cellPoints_[slot] = i;
+        cellX_[slot] = xs[i];
+        cellY_[slot] = ys[i];
+    }
+    delete[] cursor;
+}
+
+int SpatialGrid::clampColumn(double x) const {
+    double column = (x - minX_) * inverseCellSize_;
+    if (column < 0) return 0;
+    if (column >= columns_) return columns_ - 1;
+    return static_cast<int>(column);
+}
+
+int SpatialGrid::clampRow(double y) const {
+    double row = (y - minY_) * inverseCellSize_;
+    if (row < 0) return 0;
+    if (row >= rows_) return rows_ - 1;
+    return static_cast<int>(row);
+}
+
+void SpatialGrid::scanCell(int column, int row, double x, double y, int& best, double& bestDistance2) const {
+    int cell = row * columns_ + column;
+    for (int k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) {
+        double dx = cellX_[k] - x;
+        double dy = cellY_[k] - y;
+        double d2 = dx * dx + dy * dy;
+        if (best < 0 || d2 < bestDistance2 || (d2 == bestDistance2 && cellPoints_[k] < best)) {
+            best = cellPoints_[k];
+            bestDistance2 = d2;
+        }
+    }
+}
+
+int SpatialGrid::nearest(double x, double y, double& distance2) const {
+    int best = -1;
+    double bestDistance2 = 0;
+    if (count_ == 0) {
+        distance2 = 0;
+        return -1;
+    }
+
+    int cx = clampColumn(x);
+    int cy = clampRow(y);
+    int maxRing = columns_ > rows_ ? columns_ : rows_;
+    for (int r = 0; r <= maxRing; ++r) {
+        int left = cx - r;
+        int right = cx + r;
+        int bottom = cy - r;
+        int top = cy + r;
+
+        if (r == 0) {
+            scanCell(cx, cy, x, y, best, bestDistance2);
+        } else {
+            // Top and bottom rows of the ring, then the side columns between them.
+            for (int column = left; column <= right; ++column) {
+                if (column < 0 || column >= columns_) continue;
+                if (bottom >= 0) scanCell(column, bottom, x, y, best, bestDistance2);
+                if (top < rows_) scanCell(column, top, x, y, best, bestDistance2);
+            }
+            for (int row = bottom + 1; row < top; ++row) {
+                if (row < 0 || row >= rows_) continue;
+                if (left >= 0) scanCell(left, row, x, y, best, bestDistance2);
+                if (right < columns_) scanCell(right, row, x, y, best, bestDistance2);
+            }
+        }
+
+        if (best >= 0) {
+            // Anything in ring r + 1 is at least this far from (x, y).
+            double gap = x - (minX_ + left * cellSize_);
+            double side = minX_ + (right + 1) * cellSize_ - x;
+            if (side < gap) gap = side;
+            side = y - (minY_ + bottom * cellSize_);
+            if (side < gap) gap = side;
+            side = minY_ + (top + 1) * cellSize_ - y;
+            if (side < gap) gap = side;
+            if (gap > 0 && gap * gap > bestDistance2) break;
+        }
+    }
+
+    distance2 = bestDistance2;
+    return best;
+}
+
+int SpatialGrid::nearestByScan(const double* xs, const double* ys, int count,
+                               double x, double y, double& distance2) {
+    int best = -1;
+    double bestDistance2 = 0;
+    for (int i = 0; i < count; ++i) {
+        double dx = xs[i] - x;
+        double dy = ys[i] - y;
+        double d2 = dx * dx + dy * dy;
+        if (best < 0 || d2 < bestDistance2) {
+            best = i;
+            bestDistance2 = d2;
+        }
+    }
+    distance2 = bestDistance2;
+    return best;
+}
+
+long long SpatialGrid::getMemoryUsage() const {
+    long long cells = static_cast<long long>(columns_) * rows_;
+    return static_cast<long long>(sizeof(*this))
+         + (count_ > 0 ? (cells + 1 + count_) * static_cast<long long>(sizeof(int))
+                         + 2LL * count_ * static_cast<long long>(sizeof(double)) : 0);
+}
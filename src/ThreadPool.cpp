@@ -0,0 +1,87 @@
+/* ThreadPool.cpp
+ * Implementation of ThreadPool.
+ */
+
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+    : threadCount_(threadCount > 0 ? threadCount : 1), workers_(nullptr),
+      generation_(0), stopping_(false), busyWorkers_(0),
+      task_(nullptr), context_(nullptr), taskCount_(0), nextTask_(0) {
+    int workerCount = threadCount_ - 1;
+    if (workerCount > 0) {
+        workers_ = new std::thread[workerCount];
+        for (int i = 0; i < workerCount; ++i) {
+            workers_[i] = std::thread(&ThreadPool::workerLoop, this);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    startCv_.notify_all();
+    for (int i = 0; i < threadCount_ - 1; ++i) {
+        workers_[i].join();
+    }
+    delete[] workers_;
+}
+
+int ThreadPool::hardwareThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+void ThreadPool::drainTasks() {
+    while (true) {
+        int index = nextTask_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= taskCount_) return;
+        task_(index, context_);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    long long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+
+        drainTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busyWorkers_--;
+        }
+        doneCv_.notify_one();
+    }
+}
+
+void ThreadPool::run(int taskCount, TaskFunction task, void* context) {
+    if (taskCount <= 0) return;
+    if (threadCount_ == 1 || taskCount == 1) {
+        for (int i = 0; i < taskCount; ++i) task(i, context);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = task;
+        context_ = context;
+        taskCount_ = taskCount;
+        nextTask_.store(0, std::memory_order_relaxed);
+        busyWorkers_ = threadCount_ - 1;
+        generation_++;
+    }
+    startCv_.notify_all();
+
+    drainTasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [&] { return busyWorkers_ == 0; });
+}
@@ -0,0 +1,237 @@
+/* Topology.cpp
+ * Implementation of Topology.
+ */
+
+#include "../include/Topology.h"
+#include "../include/Clock.h"
+#include "../include/basicIO.h"
+
+#include <cmath> // for std::sqrt, std::ceil
+
+Topology::Topology(const CommunicationProtocol* protocol, const TopologyConfig& config, int firstDeviceId)
+    : protocol_(protocol), config_(config), pendingCount_(0), rng_(config.seed ? config.seed : 1) {
+    towerCount_ = config_.towerCount > 0 ? config_.towerCount : 1;
+    deviceCount_ = config_.deviceCount > 0 ? config_.deviceCount : towerCount_ * 20;
+    if (config_.stepMs < 1) config_.stepMs = 1;
+    if (config_.maxSpeed < config_.minSpeed) config_.maxSpeed = config_.minSpeed;
+    int capacity = config_.towerCapacity > 0 ? config_.towerCapacity : CellTower::MAX_DEVICES;
+
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(towerCount_))));
+    int rows = (towerCount_ + columns - 1) / columns;
+    width_ = columns * config_.spacingM;
+    height_ = rows * config_.spacingM;
+
+    towers_ = new CellTower*[towerCount_];
+    towerX_ = new double[towerCount_];
+    towerY_ = new double[towerCount_];
+    for (int t = 0; t < towerCount_; ++t) {
+        towers_[t] = new CellTower(t + 1, protocol_, capacity);
+        if (config_.layout == TowerLayout::RANDOM) {
+            towerX_[t] = nextUniform() * width_;
+            towerY_[t] = nextUniform() * height_;
+        } else {
+            towerX_[t] = (t % columns + 0.5) * config_.spacingM;
+            towerY_[t] = (t / columns + 0.5) * config_.spacingM;
+        }
+    }
+
+    towerGrid_.build(towerX_, towerY_, towerCount_, 0, 0, width_, height_);
+
+    deviceIds_ = new int[deviceCount_];
+    deviceTypes_ = new ConnectionType[deviceCount_];
+    x_ = new double[deviceCount_];
+    y_ = new double[deviceCount_];
+    destX_ = new double[deviceCount_];
+    destY_ = new double[deviceCount_];
+    speed_ = new double[deviceCount_];
+    serving_ = new int[deviceCount_];
+    pendingDevice_ = new int[deviceCount_];
+    pendingTower_ = new int[deviceCount_];
+    for (int d = 0; d < deviceCount_; ++d) {
+        deviceIds_[d] = firstDeviceId + d;
+        deviceTypes_[d] = (d % 3 == 2) ? ConnectionType::VOICE : ConnectionType::DATA;
+        x_[d] = nextUniform() * width_;
+        y_[d] = nextUniform() * height_;
+        serving_[d] = -1;
+        pickWaypoint(d);
+    }
+}
+
+Topology::~Topology() {
+    for (int t = 0; t < towerCount_; ++t) delete towers_[t];
+    delete[] towers_;
+    delete[] towerX_;
+    delete[] towerY_;
+    delete[] deviceIds_;
+    delete[] deviceTypes_;
+    delete[] x_;
+    delete[] y_;
+    delete[] destX_;
+    delete[] destY_;
+    delete[] speed_;
+    delete[] serving_;
+    delete[] pendingDevice_;
+    delete[] pendingTower_;
+}
+
+// xorshift64*, as in EventSimulator: a fixed seed reproduces the run.
+double Topology::nextUniform() {
+    rng_ ^= rng_ >> 12;
+    rng_ ^= rng_ << 25;
+    rng_ ^= rng_ >> 27;
+    unsigned long long bits = (rng_ * 2685821657736338717ULL) >> 11;
+    return static_cast<double>(bits) * (1.0 / 9007199254740992.0); // [0, 1)
+}
+
+void Topology::pickWaypoint(int device) {
+    destX_[device] = nextUniform() * width_;
+    destY_[device] = nextUniform() * height_;
+    speed_[device] = config_.minSpeed + nextUniform() * (config_.maxSpeed - config_.minSpeed);
+}
+
+int Topology::nearestTower(double x, double y, double& distance2) const {
+    if (config_.spatialIndex) return towerGrid_.nearest(x, y, distance2);
+    return SpatialGrid::nearestByScan(towerX_, towerY_, towerCount_, x, y, distance2);
+}
+
+void Topology::attachAll() {
+    // Quiet single-row attach, as in executeHandovers().
+    for (int d = 0; d < deviceCount_; ++d) {
+        double distance2;
+        int t = nearestTower(x_[d], y_[d], distance2);
+        if (towers_[t]->addUserDevices(&deviceIds_[d], &deviceTypes_[d], 1) == 1) {
+            serving_[d] = t;
+        } else {
+            stats_.attachFailures++;
+        }
+    }
+}
+
+void Topology::move(double seconds) {
+    for (int d = 0; d < deviceCount_; ++d) {
+        double dx = destX_[d] - x_[d];
+        double dy = destY_[d] - y_[d];
+        double remaining = std::sqrt(dx * dx + dy * dy);
+        double travel = speed_[d] * seconds;
+        if (travel >= remaining) {
+            x_[d] = destX_[d];
+            y_[d] = destY_[d];
+            pickWaypoint(d);
+        } else {
+            double scale = travel / remaining;
+            x_[d] += dx * scale;
+            y_[d] += dy * scale;
+        }
+    }
+}
+
+void Topology::select() {
+    pendingCount_ = 0;
+    double hysteresis = config_.hysteresisM;
+    for (int d = 0; d < deviceCount_; ++d) {
+        double best2;
+        int best = nearestTower(x_[d], y_[d], best2);
+        int current = serving_[d];
+        if (current == best) continue;
+
+        if (current >= 0) {
+            double dx = towerX_[current] - x_[d];
+            double dy = towerY_[current] - y_[d];
+            double currentDistance = std::sqrt(dx * dx + dy * dy);
+            if (std::sqrt(best2) + hysteresis >= currentDistance) continue;
+        }
+        pendingDevice_[pendingCount_] = d;
+        pendingTower_[pendingCount_] = best;
+        pendingCount_++;
+    }
+}
+
+void Topology::executeHandovers() {
+    for (int i = 0; i < pendingCount_; ++i) {
+        int d = pendingDevice_[i];
+        int target = pendingTower_[i];
+        int source = serving_[d];
+
+        // Make before break: the device keeps its old tower if the target is full.
+        // The batch form is used because it attaches without printing when full.
+        bool attached = towers_[target]->addUserDevices(&deviceIds_[d], &deviceTypes_[d], 1) == 1;
+        if (source < 0) {
+            if (attached) {
+                serving_[d] = target;
+            } else {
+                stats_.attachFailures++;
+            }
+            continue;
+        }
+
+        stats_.attempts++;
+        if (attached) {
+            towers_[source]->removeUserDevice(deviceIds_[d]);
+            serving_[d] = target;
+            stats_.handovers++;
+        } else {
+            stats_.capacityFailures++;
+        }
+    }
+}
+
+void Topology::run() {
+    long long wallStart = Clock::nowNanoseconds();
+    long long steps = config_.durationMs / config_.stepMs;
+    double seconds = config_.stepMs / 1000.0;
+
+    for (long long s = 0; s < steps; ++s) {
+        long long t0 = Clock::nowNanoseconds();
+        move(seconds);
+        long long t1 = Clock::nowNanoseconds();
+        select();
+        long long t2 = Clock::nowNanoseconds();
+        executeHandovers();
+        long long t3 = Clock::nowNanoseconds();
+
+        stats_.mobilityNs += t1 - t0;
+        stats_.selectionNs += t2 - t1;
+        stats_.handoverNs += t3 - t2;
+    }
+
+    stats_.steps = steps;
+    stats_.simulatedNs = steps * config_.stepMs * 1000000;
+    stats_.attached = 0;
+    for (int d = 0; d < deviceCount_; ++d) {
+        if (serving_[d] >= 0) stats_.attached++;
+    }
+    stats_.unattached = deviceCount_ - stats_.attached;
+    stats_.wallNs = Clock::nowNanoseconds() - wallStart;
+}
+
+long long Topology::getMemoryUsage() const {
+    long long bytes = static_cast<long long>(sizeof(*this)) - static_cast<long long>(sizeof(SpatialGrid))
+                    + static_cast<long long>(towerCount_) * (sizeof(CellTower*) + 2 * sizeof(double))
+                    + static_cast<long long>(deviceCount_)
+                        * (5 * sizeof(double) + 4 * sizeof(int) + sizeof(ConnectionType));
+    for (int t = 0; t < towerCount_; ++t) bytes += towers_[t]->getMemoryUsage();
+    bytes += towerGrid_.getMemoryUsage();
+    return bytes;
+}
+
+void Topology::printReport() const {
+    io.outputstring("\n========== Topology & Handover ==========\n"); io.terminate();
+    io.outputstring("Towers: "); io.outputint(towerCount_);
+    io.outputstring(config_.layout == TowerLayout::RANDOM ? " (random layout" : " (grid layout");
+    io.outputstring(config_.spatialIndex ? ", spatial index)" : ", linear scan)");
+    io.terminate();
+    io.outputstring("Mobile devices: "); io.outputint(deviceCount_);
+    io.outputstring(" (attached at end: "); io.outputint(stats_.attached); io.outputstring(")"); io.terminate();
+    io.outputstring("Simulated time (ms): "); io.outputlong(stats_.simulatedNs / 1000000);
+    io.outputstring(" in "); io.outputlong(stats_.steps); io.outputstring(" steps"); io.terminate();
+    io.outputstring("Handover attempts: "); io.outputlong(stats_.attempts); io.terminate();
+    io.outputstring("Handovers completed: "); io.outputlong(stats_.handovers); io.terminate();
+    io.outputstring("Failed (target at capacity): "); io.outputlong(stats_.capacityFailures); io.terminate();
+    io.outputstring("Refused attach attempts (retried each step): "); io.outputlong(stats_.attachFailures); io.terminate();
+    io.outputstring("Time moving devices (us): "); io.outputlong(stats_.mobilityNs / 1000); io.terminate();
+    io.outputstring("Time selecting towers (us): "); io.outputlong(stats_.selectionNs / 1000); io.terminate();
+    io.outputstring("Time executing handovers (us): "); io.outputlong(stats_.handoverNs / 1000);
+    io.outputstring(" ("); io.outputlong(Clock::ratePerSecond(stats_.attempts, stats_.handoverNs));
+    io.outputstring(" handovers/sec)"); io.terminate();
+    io.outputstring("Memory usage (bytes): "); io.outputlong(getMemoryUsage()); io.terminate();
+}
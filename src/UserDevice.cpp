@@ -3,31 +3,28 @@
  */
 
 #include "../include/UserDevice.h"
-#include "../include/basicIO.h"
+#include "../include/DeviceTable.h"
 
-void UserDevice::validate() const {
-    if (deviceId_ <= 0) {
-        io.outputstring("Error: Device ID must be positive");
-        io.terminate();
-    }
-    // Frequency can be 0 (first channel) or positive; just check it's not negative
-    if (assignedFrequency_ < 0) {
-        io.outputstring("Error: Assigned frequency must be non-negative");
-        io.terminate();
-    }
+int UserDevice::getDeviceId() const {
+    return table_->getId(row_);
 }
 
-UserDevice::UserDevice(int deviceId, int frequency, ConnectionType type)
-    : deviceId_(deviceId), assignedFrequency_(frequency), 
-      connectionType_(type), isConnected_(true) {
-    validate();
+int UserDevice::getAssignedFrequency() const {
+    return table_->getFrequency(row_);
 }
 
-void UserDevice::setAssignedFrequency(int frequency) {
-    if (frequency < 0) {
-        io.outputstring("Error: Assigned frequency must be non-negative");
-        io.terminate();
-        return;
-    }
-    assignedFrequency_ = frequency;
+ConnectionType UserDevice::getConnectionType() const {
+    return table_->getType(row_);
+}
+
+bool UserDevice::isConnected() const {
+    return table_->isConnected(row_);
+}
+
+void UserDevice::setConnectionType(ConnectionType type) {
+    table_->setType(row_, type);
+}
+
+void UserDevice::setConnected(bool connected) {
+    table_->setConnected(row_, connected);
 }
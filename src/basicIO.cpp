@@ -0,0 +1,197 @@
+#include "../include/basicIO.h"
+
+#define SYS_READ 0
+#define SYS_WRITE 1
+#define SYS_IOCTL 16
+#define STDIN 0
+#define STDOUT 1
+#define STDERR 2
+#define TCGETS 0x5401
+
+
+basicIO io;
+
+extern "C" long syscall3(long number, long arg1, long arg2, long arg3);
+
+static char inputBuffer[256];
+
+static const char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Formats number right-aligned into the end of buffer[0..size) two digits at a
+// time and returns the index of the first character.
+static int formatInt(long long number, char* buffer, int size) {
+    unsigned long long value = number < 0 ? 0ull - static_cast<unsigned long long>(number)
+                                          : static_cast<unsigned long long>(number);
+    int pos = size;
+    while (value >= 100) {
+        unsigned int pair = static_cast<unsigned int>(value % 100) * 2;
+        value /= 100;
+        buffer[--pos] = DIGIT_PAIRS[pair + 1];
+        buffer[--pos] = DIGIT_PAIRS[pair];
+    }
+    if (value >= 10) {
+        unsigned int pair = static_cast<unsigned int>(value) * 2;
+        buffer[--pos] = DIGIT_PAIRS[pair + 1];
+        buffer[--pos] = DIGIT_PAIRS[pair];
+    } else {
+        buffer[--pos] = static_cast<char>('0' + value);
+    }
+    if (number < 0) buffer[--pos] = '-';
+    return pos;
+}
+
+static void writeAll(int fd, const char* data, long len) {
+    while (len > 0) {
+        long written = syscall3(SYS_WRITE, fd, (long)data, len);
+        if (written <= 0) return;
+        data += written;
+        len -= written;
+    }
+}
+
+basicIO::basicIO() : outputLength_(0), interactive_(-1), inputClosed_(false) {}
+
+basicIO::~basicIO() {
+    flush();
+}
+
+bool basicIO::isInteractive() {
+    if (interactive_ < 0) {
+        char termios[64];
+        interactive_ = syscall3(SYS_IOCTL, STDOUT, TCGETS, (long)termios) == 0 ? 1 : 0;
+    }
+    return interactive_ == 1;
+}
+
+void basicIO::append(const char* data, long len) {
+    bool sawNewline = false;
+    while (len > 0) {
+        if (outputLength_ == OUTPUT_BUFFER_SIZE) flush();
+        long room = OUTPUT_BUFFER_SIZE - outputLength_;
+        long chunk = len < room ? len : room;
+        char* dst = outputBuffer_ + outputLength_;
+        for (long i = 0; i < chunk; ++i) {
+            dst[i] = data[i];
+            sawNewline |= (data[i] == '\n');
+        }
+        outputLength_ += static_cast<int>(chunk);
+        data += chunk;
+        len -= chunk;
+    }
+    if (sawNewline && isInteractive()) flush();
+}
+
+void basicIO::flush() {
+    if (outputLength_ == 0) return;
+    writeAll(STDOUT, outputBuffer_, outputLength_);
+    outputLength_ = 0;
+}
+
+void basicIO::activateInput() {
+    for (int i = 0; i < 256; ++i) inputBuffer[i] = 0;
+}
+
+int basicIO::inputint() {
+    flush();
+    // Read one line a byte at a time so piped input with several answers is
+    // consumed one answer per call.
+    char buffer[32] = {0};
+    int len = 0;
+    while (true) {
+        char ch;
+        long bytes = syscall3(SYS_READ, STDIN, (long)&ch, 1);
+        if (bytes <= 0) {
+            inputClosed_ = true;
+            break;
+        }
+        if (ch == '\n') break;
+        if (len < 31) buffer[len++] = ch;
+    }
+    if (len == 0) return 0;
+    buffer[len] = '\0';
+    int result = 0;
+    int i = 0;
+    bool neg = false;
+    if (buffer[0] == '-') {
+        neg = true;
+        i++;
+    }
+    for (; buffer[i] >= '0' && buffer[i] <= '9'; ++i) {
+        result = result * 10 + (buffer[i] - '0');
+    }
+    return neg ? -result : result;
+}
+
+const char* basicIO::inputstring() {
+    flush();
+    syscall3(SYS_READ, STDIN, (long)inputBuffer, 255);
+    return inputBuffer;
+}
+
+
+void basicIO::inputstring(char* buffer, int size) {
+    if (!buffer || size <= 0) return;
+    flush();
+
+    char ch;
+    int i = 0;
+
+    while (i < size - 1) {
+        long bytes = syscall3(SYS_READ, STDIN, (long)&ch, 1);
+        if (bytes <= 0 || ch == '\n') break;
+        buffer[i++] = ch;
+    }
+    buffer[i] = '\0';
+}
+
+void basicIO::outputint(int number) {
+    char buffer[16];
+    int start = formatInt(number, buffer, sizeof(buffer));
+    append(buffer + start, sizeof(buffer) - start);
+}
+
+void basicIO::outputlong(long long value) {
+    char buffer[24];
+    int start = formatInt(value, buffer, sizeof(buffer));
+    append(buffer + start, sizeof(buffer) - start);
+}
+
+void basicIO::outputstring(const char* text) {
+    long len = 0;
+    while (text[len]) ++len;
+    append(text, len);
+}
+
+void basicIO::terminate() {
+    append("\n", 1);
+}
+
+// Error output goes straight to stderr and leaves the stdout buffer alone, so
+// worker threads can report errors while the main thread owns stdout.
+void basicIO::errorstring(const char* text) {
+    long len = 0;
+    while (text[len]) ++len;
+    writeAll(STDERR, text, len);
+}
+
+void basicIO::errorint(int number) {
+    char buffer[16];
+    int start = formatInt(number, buffer, sizeof(buffer));
+    writeAll(STDERR, buffer + start, sizeof(buffer) - start);
+}
+
+void basicIO::errorlong(long long number) {
+    char buffer[24];
+    int start = formatInt(number, buffer, sizeof(buffer));
+    writeAll(STDERR, buffer + start, sizeof(buffer) - start);
+}